@@ -2,6 +2,8 @@
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QDir>
+#include <QInputDialog>
+#include <QMessageBox>
 #include <algorithm>
 
 #include "resourcemanager.h"
@@ -26,9 +28,18 @@ AddSoundFeatureWidget::AddSoundFeatureWidget(QWidget *parent)
     ResourceManager* rm = ResourceManager::instance();
     connect(rm, &ResourceManager::processingStarted, this, [this]() {
         createFeatureBtn->setEnabled(false);
+        addToFeatureBtn->setEnabled(false);
+        removeFromFeatureBtn->setEnabled(false);
     });
     connect(rm, &ResourceManager::processingFinished, this, [this]() {
         createFeatureBtn->setEnabled(true);
+        addToFeatureBtn->setEnabled(true);
+        removeFromFeatureBtn->setEnabled(true);
+    });
+    connect(rm, &ResourceManager::processingCancelled, this, [this]() {
+        createFeatureBtn->setEnabled(true);
+        addToFeatureBtn->setEnabled(true);
+        removeFromFeatureBtn->setEnabled(true);
     });
 }
 
@@ -54,10 +65,21 @@ void AddSoundFeatureWidget::setupFeatureInputUI()
     fileNameInput = new QLineEdit(this);
     fileNameInput->setPlaceholderText(Constants::FILE_NAME_PLACEHOLDER);
     createFeatureBtn = new QPushButton(Constants::CREATE_FEATURE_BUTTON, this);
+    addToFeatureBtn = new QPushButton(Constants::ADD_TO_FEATURE_BUTTON, this);
+    removeFromFeatureBtn = new QPushButton(Constants::REMOVE_FROM_FEATURE_BUTTON, this);
+    fullLengthCheck = new QCheckBox(Constants::FULL_LENGTH_EMBEDDING_CHECKBOX, this);
+    fullLengthCheck->setChecked(true);
+    energyPoolingCheck = new QCheckBox(Constants::ENERGY_POOLING_CHECKBOX, this);
+    // A single window has nothing to weight
+    connect(fullLengthCheck, &QCheckBox::toggled, energyPoolingCheck, &QCheckBox::setEnabled);
 
     inputBtnLayout->addWidget(fileNameLabel);
     inputBtnLayout->addWidget(fileNameInput);
+    inputBtnLayout->addWidget(fullLengthCheck);
+    inputBtnLayout->addWidget(energyPoolingCheck);
     inputBtnLayout->addWidget(createFeatureBtn);
+    inputBtnLayout->addWidget(addToFeatureBtn);
+    inputBtnLayout->addWidget(removeFromFeatureBtn);
 
     mainLayout->addLayout(inputBtnLayout);
 }
@@ -71,35 +93,92 @@ void AddSoundFeatureWidget::setupFeatureButtonConnections()
 {
     // Connect create feature button to process selected files
     connect(createFeatureBtn, &QPushButton::clicked, [this]() {
-        QStringList selectedFiles;
-
-        // Collect selected files from folder widgets
-        QMap<QString, FolderWidget*> folders = ResourceManager::instance()->getFolders(fileType());
-        for (FolderWidget* fw : folders.values()) {
-            QStringList selected = fw->getSelectedFiles();
-            for (const QString& path : selected) {
-                selectedFiles.append(path);
-            }
+        QString outputFileName = getOutputFileName();
+        if (outputFileName.isEmpty()) {
+            qDebug() << "Output file name is empty.";
+            return;
+        }
+
+        EmbeddingOptions options;
+        options.coverage = fullLengthCheck->isChecked() ? EmbeddingCoverage::FullLength : EmbeddingCoverage::FirstClip;
+        options.pooling = energyPoolingCheck->isChecked() ? WindowPooling::EnergyWeighted : WindowPooling::Mean;
+        ResourceManager::instance()->startGenerateAudioFeatures(selectedFiles(), outputFileName, options);
+    });
+
+    // Extend a saved feature: only files it does not hold yet are embedded
+    connect(addToFeatureBtn, &QPushButton::clicked, [this]() {
+        QStringList files = selectedFiles();
+        if (files.isEmpty()) {
+            qDebug() << "No files selected to add.";
+            return;
         }
 
-        // Collect selected files from single file widgets
-        QMap<QString, FileWidget*> singles = ResourceManager::instance()->getSingleFiles(fileType());
-        for (FileWidget* fw : singles.values()) {
-            if (fw->checkBox()->isChecked()) {
-                selectedFiles.append(fw->filePath());
-            }
+        QStringList features = ResourceManager::instance()->updatableFeatures();
+        if (features.isEmpty()) {
+            QMessageBox::information(this, Constants::ADD_TO_FEATURE_BUTTON, Constants::NO_UPDATABLE_FEATURES_MESSAGE);
+            return;
         }
 
-        QString outputFileName = getOutputFileName();
-        if (outputFileName.isEmpty()) {
-            qDebug() << "Output file name is empty.";
+        bool ok = false;
+        QString featureName = QInputDialog::getItem(this, Constants::ADD_TO_FEATURE_BUTTON,
+                                                    Constants::ADD_TO_FEATURE_PROMPT, features, 0, false, &ok);
+        if (ok && !featureName.isEmpty()) {
+            ResourceManager::instance()->startAddFilesToFeature(featureName, files);
+        }
+    });
+
+    // Shrink a saved feature: the mean is recomputed from the remaining members, no model needed
+    connect(removeFromFeatureBtn, &QPushButton::clicked, [this]() {
+        QStringList files = selectedFiles();
+        if (files.isEmpty()) {
+            qDebug() << "No files selected to remove.";
+            return;
+        }
+
+        QStringList features = ResourceManager::instance()->updatableFeatures();
+        if (features.isEmpty()) {
+            QMessageBox::information(this, Constants::REMOVE_FROM_FEATURE_BUTTON, Constants::NO_UPDATABLE_FEATURES_MESSAGE);
             return;
         }
 
-        ResourceManager::instance()->startGenerateAudioFeatures(selectedFiles, outputFileName);
+        bool ok = false;
+        QString featureName = QInputDialog::getItem(this, Constants::REMOVE_FROM_FEATURE_BUTTON,
+                                                    Constants::REMOVE_FROM_FEATURE_PROMPT, features, 0, false, &ok);
+        if (ok && !featureName.isEmpty()
+            && !ResourceManager::instance()->removeFilesFromFeature(featureName, files)) {
+            QMessageBox::information(this, Constants::REMOVE_FROM_FEATURE_BUTTON,
+                                     Constants::REMOVE_FROM_FEATURE_FAILED_MESSAGE);
+        }
     });
 }
 
+/**
+ * @brief Collects the checked files from folder widgets and single file widgets.
+ * @return Paths of the selected files.
+ */
+QStringList AddSoundFeatureWidget::selectedFiles() const
+{
+    QStringList selectedFiles;
+
+    // Collect selected files from folder widgets
+    QMap<QString, FolderWidget*> folders = ResourceManager::instance()->getFolders(fileType());
+    for (FolderWidget* fw : folders.values()) {
+        QStringList selected = fw->getSelectedFiles();
+        for (const QString& path : selected) {
+            selectedFiles.append(path);
+        }
+    }
+
+    // Collect selected files from single file widgets
+    QMap<QString, FileWidget*> singles = ResourceManager::instance()->getSingleFiles(fileType());
+    for (FileWidget* fw : singles.values()) {
+        if (fw->checkBox()->isChecked()) {
+            selectedFiles.append(fw->filePath());
+        }
+    }
+    return selectedFiles;
+}
+
 /**
  * @brief Sorts all folders and single files based on the specified type.
  *
@@ -7,6 +7,7 @@
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
+#include <QCheckBox>
 #include <QMap>
 #include <QSet>
 #include "filemanagerwidget.h"
@@ -56,10 +57,15 @@ private:
     QLabel* fileNameLabel;       ///< Label for file name input
     QLineEdit* fileNameInput;     ///< Input field for generated file name
     QPushButton* createFeatureBtn; ///< Button to create the feature
+    QPushButton* addToFeatureBtn;  ///< Button to add the selected files to an existing feature
+    QPushButton* removeFromFeatureBtn; ///< Button to drop the selected files from an existing feature
+    QCheckBox* fullLengthCheck;    ///< Embed whole files with sliding windows instead of the first 10 s
+    QCheckBox* energyPoolingCheck; ///< Weight window embeddings by RMS; only used with fullLengthCheck
 
     // Private Methods
     void setupFeatureInputUI();               ///< Sets up the feature input UI components
     void setupFeatureButtonConnections();     ///< Sets up the connections for the feature creation button
+    QStringList selectedFiles() const;        ///< Checked files from every folder and single file widget
 };
 
 #endif // ADDSOUNDFEATUREWIDGET_H
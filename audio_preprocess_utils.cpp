@@ -5,11 +5,17 @@
 #include <QDir>
 #include <QDebug>
 #include <cmath>
+#include <algorithm>
 
 namespace AudioPreprocessUtils {
 
 torch::Tensor loadAudio(const QString& filePath) {
+    return loadAudio(filePath, -1.0, nullptr);
+}
+
+torch::Tensor loadAudio(const QString& filePath, double maxSeconds, bool* tooLong) {
     qDebug() << "AudioPreprocessUtils::loadAudio - Loading file:" << filePath;
+    if (tooLong) *tooLong = false;
 
     SF_INFO sfinfo;
     SNDFILE* file = sf_open(filePath.toStdString().c_str(), SFM_READ, &sfinfo);
@@ -19,6 +25,14 @@ torch::Tensor loadAudio(const QString& filePath) {
         return torch::empty({0});
     }
 
+    // 超過長度上限的檔案不解碼，交給呼叫端改走串流
+    if (maxSeconds >= 0.0 && sfinfo.samplerate > 0
+        && static_cast<double>(sfinfo.frames) / sfinfo.samplerate > maxSeconds) {
+        sf_close(file);
+        if (tooLong) *tooLong = true;
+        return torch::empty({0});
+    }
+
     std::vector<float> audio(sfinfo.frames * sfinfo.channels);
     sf_count_t read = sf_read_float(file, audio.data(), audio.size());
     sf_close(file);
@@ -163,6 +177,24 @@ torch::Tensor trimSilence(const torch::Tensor& audio, float threshold) {
     return audio.slice(0, start, end);
 }
 
+torch::Tensor silentChunkMask(const torch::Tensor& chunks, float rmsThreshold, float peakThreshold) {
+    if (chunks.dim() != 2 || chunks.size(0) == 0) {
+        return torch::zeros({chunks.dim() > 0 ? chunks.size(0) : 0}, torch::kBool);
+    }
+
+    torch::Tensor rms = chunks.pow(2).mean(1).sqrt();
+    torch::Tensor peak = chunks.abs().amax(1);
+    return (rms < rmsThreshold).logical_and(peak < peakThreshold);
+}
+
+double signalToNoiseDb(const torch::Tensor& reference, const torch::Tensor& estimate) {
+    torch::Tensor ref = reference.flatten().to(torch::kDouble);
+    torch::Tensor noise = ref - estimate.flatten().to(torch::kDouble);
+    double signalPower = ref.pow(2).sum().item<double>();
+    double noisePower = noise.pow(2).sum().item<double>();
+    return 10.0 * std::log10(std::max(signalPower, 1e-20) / std::max(noisePower, 1e-20));
+}
+
 bool saveToWav(const torch::Tensor& audio, const QString& filePath, int sampleRate) {
     if (audio.numel() == 0) {
         std::cerr << "Empty audio tensor, cannot save to WAV: " << filePath.toStdString() << std::endl;
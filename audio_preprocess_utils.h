@@ -16,6 +16,18 @@ namespace AudioPreprocessUtils {
  */
 torch::Tensor loadAudio(const QString& filePath);
 
+/**
+ * @brief Loads audio data unless the file is longer than a limit.
+ *
+ * The duration comes from the same open that decodes the file, so callers that
+ * route long files elsewhere need no separate probe.
+ * @param filePath The path to the audio file.
+ * @param maxSeconds Longest file to decode (< 0 = no limit).
+ * @param tooLong Set to true, with nothing decoded, if the file exceeds maxSeconds.
+ * @return A tensor representing the audio samples; empty if too long or unreadable.
+ */
+torch::Tensor loadAudio(const QString& filePath, double maxSeconds, bool* tooLong);
+
 /**
  * @brief Normalizes audio data to a specified range.
  * @param audio The input audio tensor.
@@ -58,6 +70,23 @@ torch::Tensor extractChannel(const torch::Tensor& audio, int channelIndex, int n
  */
 torch::Tensor trimSilence(const torch::Tensor& audio, float threshold = 0.01f);
 
+/**
+ * @brief Flags chunks whose energy is below the noise floor.
+ * @param chunks Audio chunks of shape (N, samples).
+ * @param rmsThreshold A chunk is silent only if its RMS is below this value.
+ * @param peakThreshold ...and its absolute peak is below this value.
+ * @return Boolean tensor of shape (N), true for silent chunks.
+ */
+torch::Tensor silentChunkMask(const torch::Tensor& chunks, float rmsThreshold, float peakThreshold);
+
+/**
+ * @brief Signal-to-noise ratio of an estimate against a reference signal.
+ * @param reference The reference signal.
+ * @param estimate The estimate, same number of elements as the reference.
+ * @return 10 * log10(|reference|^2 / |reference - estimate|^2) in dB.
+ */
+double signalToNoiseDb(const torch::Tensor& reference, const torch::Tensor& estimate);
+
 /**
  * @brief Saves a torch::Tensor as a WAV file.
  * @param audio The audio tensor to save (1D or 2D).
@@ -0,0 +1,213 @@
+#include "audiostream.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const sf_count_t DECODE_BLOCK_FRAMES = 65536; ///< Source frames decoded per block
+}
+
+AudioStreamReader::AudioStreamReader(int targetSampleRate)
+    : m_targetSampleRate(targetSampleRate),
+      m_file(nullptr),
+      m_info(),
+      m_resampler(nullptr),
+      m_sourceDone(true),
+      m_pendingPos(0)
+{
+}
+
+AudioStreamReader::~AudioStreamReader()
+{
+    close();
+}
+
+bool AudioStreamReader::open(const QString& filePath)
+{
+    close();
+
+    m_info = SF_INFO();
+    m_file = sf_open(filePath.toStdString().c_str(), SFM_READ, &m_info);
+    if (!m_file) {
+        qDebug() << "AudioStreamReader::open - Error opening file:" << filePath << "-" << sf_strerror(nullptr);
+        return false;
+    }
+
+    if (m_info.samplerate != m_targetSampleRate) {
+        int error = 0;
+        m_resampler = src_new(SRC_SINC_BEST_QUALITY, 1, &error);
+        if (!m_resampler) {
+            qDebug() << "AudioStreamReader::open - Failed to create resampler:" << src_strerror(error);
+            close();
+            return false;
+        }
+    }
+
+    m_sourceDone = false;
+    m_pending.clear();
+    m_pendingPos = 0;
+    return true;
+}
+
+void AudioStreamReader::close()
+{
+    if (m_file) {
+        sf_close(m_file);
+        m_file = nullptr;
+    }
+    if (m_resampler) {
+        src_delete(m_resampler);
+        m_resampler = nullptr;
+    }
+    m_sourceDone = true;
+    m_pending.clear();
+    m_pendingPos = 0;
+}
+
+torch::Tensor AudioStreamReader::read(int64_t numSamples)
+{
+    while (static_cast<int64_t>(m_pending.size() - m_pendingPos) < numSamples && !m_sourceDone) {
+        if (!decodeBlock()) {
+            break;
+        }
+    }
+
+    int64_t available = static_cast<int64_t>(m_pending.size() - m_pendingPos);
+    int64_t count = std::min(numSamples, available);
+    torch::Tensor samples = torch::empty({count}, torch::kFloat32);
+    std::copy(m_pending.begin() + m_pendingPos, m_pending.begin() + m_pendingPos + count,
+              samples.data_ptr<float>());
+    m_pendingPos += count;
+
+    // Compact once the consumed prefix dominates the buffer
+    if (m_pendingPos > m_pending.size() / 2) {
+        m_pending.erase(m_pending.begin(), m_pending.begin() + m_pendingPos);
+        m_pendingPos = 0;
+    }
+
+    return samples;
+}
+
+bool AudioStreamReader::atEnd() const
+{
+    return m_sourceDone && m_pendingPos >= m_pending.size();
+}
+
+double AudioStreamReader::durationSeconds() const
+{
+    if (m_info.samplerate <= 0) return 0.0;
+    return static_cast<double>(m_info.frames) / m_info.samplerate;
+}
+
+int64_t AudioStreamReader::estimatedTotalSamples() const
+{
+    return static_cast<int64_t>(durationSeconds() * m_targetSampleRate);
+}
+
+bool AudioStreamReader::decodeBlock()
+{
+    if (!m_file) {
+        m_sourceDone = true;
+        return false;
+    }
+
+    const int channels = m_info.channels;
+    std::vector<float> interleaved(DECODE_BLOCK_FRAMES * channels);
+    sf_count_t framesRead = sf_readf_float(m_file, interleaved.data(), DECODE_BLOCK_FRAMES);
+    bool endOfInput = framesRead < DECODE_BLOCK_FRAMES;
+
+    // Downmix to mono by averaging channels
+    std::vector<float> mono(framesRead);
+    for (sf_count_t f = 0; f < framesRead; ++f) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            sum += interleaved[f * channels + c];
+        }
+        mono[f] = sum / channels;
+    }
+
+    if (!m_resampler) {
+        m_pending.insert(m_pending.end(), mono.begin(), mono.end());
+        m_sourceDone = endOfInput;
+        return true;
+    }
+
+    double ratio = static_cast<double>(m_targetSampleRate) / m_info.samplerate;
+    std::vector<float> output(static_cast<size_t>(DECODE_BLOCK_FRAMES * ratio) + 64);
+
+    SRC_DATA srcData;
+    srcData.data_in = mono.data();
+    srcData.input_frames = static_cast<long>(framesRead);
+    srcData.src_ratio = ratio;
+    srcData.end_of_input = endOfInput ? 1 : 0;
+
+    // Feed the block until it is consumed; at end of input keep draining the filter tail
+    while (true) {
+        srcData.data_out = output.data();
+        srcData.output_frames = static_cast<long>(output.size());
+
+        int error = src_process(m_resampler, &srcData);
+        if (error) {
+            qDebug() << "AudioStreamReader::decodeBlock - Resampling error:" << src_strerror(error);
+            m_sourceDone = true;
+            return false;
+        }
+
+        m_pending.insert(m_pending.end(), output.begin(), output.begin() + srcData.output_frames_gen);
+        srcData.data_in += srcData.input_frames_used;
+        srcData.input_frames -= srcData.input_frames_used;
+
+        if (srcData.input_frames == 0 && (!endOfInput || srcData.output_frames_gen == 0)) {
+            break;
+        }
+    }
+
+    m_sourceDone = endOfInput;
+    return true;
+}
+
+AudioStreamWriter::~AudioStreamWriter()
+{
+    close();
+}
+
+bool AudioStreamWriter::open(const QString& filePath, int sampleRate)
+{
+    close();
+
+    SF_INFO sfinfo = SF_INFO();
+    sfinfo.samplerate = sampleRate;
+    sfinfo.channels = 1;
+    sfinfo.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+    m_file = sf_open(filePath.toStdString().c_str(), SFM_WRITE, &sfinfo);
+    if (!m_file) {
+        qDebug() << "AudioStreamWriter::open - Failed to open WAV file for writing:" << filePath << "-" << sf_strerror(nullptr);
+        return false;
+    }
+    m_written = 0;
+    return true;
+}
+
+bool AudioStreamWriter::write(const torch::Tensor& samples)
+{
+    if (!m_file) return false;
+    if (samples.numel() == 0) return true;
+
+    torch::Tensor flat = samples.flatten().to(torch::kFloat32).contiguous();
+    sf_count_t written = sf_write_float(m_file, flat.data_ptr<float>(), flat.numel());
+    m_written += written;
+    return written == flat.numel();
+}
+
+void AudioStreamWriter::close()
+{
+    if (m_file) {
+        sf_close(m_file);
+        m_file = nullptr;
+    }
+}
+
+int64_t AudioStreamWriter::samplesWritten() const
+{
+    return m_written;
+}
@@ -0,0 +1,118 @@
+#ifndef AUDIOSTREAM_H
+#define AUDIOSTREAM_H
+
+#include <torch/torch.h>
+#include <QString>
+#include <sndfile.h>
+#include <samplerate.h>
+#include <vector>
+
+/**
+ * @brief Incremental audio decoder producing mono samples at the model sample rate.
+ *
+ * Reads the file block by block with libsndfile, downmixes to mono and resamples
+ * with the streaming libsamplerate API, so only a few blocks are resident at a
+ * time regardless of the file length.
+ */
+class AudioStreamReader
+{
+public:
+    /**
+     * @brief Constructs the reader.
+     * @param targetSampleRate Output sample rate in Hz (default 32000).
+     */
+    explicit AudioStreamReader(int targetSampleRate = 32000);
+    ~AudioStreamReader();
+
+    AudioStreamReader(const AudioStreamReader&) = delete;
+    AudioStreamReader& operator=(const AudioStreamReader&) = delete;
+
+    /**
+     * @brief Opens an audio file for streaming.
+     * @param filePath Path to the audio file.
+     * @return True if the file was opened successfully.
+     */
+    bool open(const QString& filePath);
+
+    /**
+     * @brief Closes the file and releases the resampler.
+     */
+    void close();
+
+    /**
+     * @brief Reads up to numSamples mono samples at the target sample rate.
+     * @param numSamples Maximum number of samples to return.
+     * @return 1D float tensor; shorter than requested only at the end of the stream.
+     */
+    torch::Tensor read(int64_t numSamples);
+
+    /**
+     * @brief Checks whether every sample has been returned.
+     */
+    bool atEnd() const;
+
+    /**
+     * @brief Duration of the source file in seconds.
+     */
+    double durationSeconds() const;
+
+    /**
+     * @brief Approximate number of output samples for the whole file.
+     */
+    int64_t estimatedTotalSamples() const;
+
+private:
+    bool decodeBlock();
+
+    int m_targetSampleRate;
+    SNDFILE* m_file;
+    SF_INFO m_info;
+    SRC_STATE* m_resampler;
+    bool m_sourceDone;             ///< All frames read from the file and flushed through the resampler
+    std::vector<float> m_pending;  ///< Decoded mono samples not yet returned
+    size_t m_pendingPos;           ///< Read offset into m_pending
+};
+
+/**
+ * @brief Incremental mono float WAV writer.
+ */
+class AudioStreamWriter
+{
+public:
+    AudioStreamWriter() = default;
+    ~AudioStreamWriter();
+
+    AudioStreamWriter(const AudioStreamWriter&) = delete;
+    AudioStreamWriter& operator=(const AudioStreamWriter&) = delete;
+
+    /**
+     * @brief Creates the output file.
+     * @param filePath Output WAV path.
+     * @param sampleRate Sample rate in Hz (default 32000).
+     * @return True if the file was created successfully.
+     */
+    bool open(const QString& filePath, int sampleRate = 32000);
+
+    /**
+     * @brief Appends samples to the file.
+     * @param samples Float tensor of any shape; written in flattened order.
+     * @return True if every sample was written.
+     */
+    bool write(const torch::Tensor& samples);
+
+    /**
+     * @brief Finalizes the header and closes the file.
+     */
+    void close();
+
+    /**
+     * @brief Number of samples written so far.
+     */
+    int64_t samplesWritten() const;
+
+private:
+    SNDFILE* m_file = nullptr;
+    int64_t m_written = 0;
+};
+
+#endif // AUDIOSTREAM_H
@@ -16,8 +16,20 @@ const QString SELECT_WAV_FILES_TEXT = "Select WAV Files or Folders to Process:";
 const QString OUTPUT_FILE_NAME_LABEL = "Output File Name:";
 const QString FILE_NAME_PLACEHOLDER = "Enter file name...";
 const QString CREATE_FEATURE_BUTTON = "Create Feature";
+const QString FULL_LENGTH_EMBEDDING_CHECKBOX = "Use whole file (not just the first 10 s)";
+const QString ENERGY_POOLING_CHECKBOX = "Weight windows by loudness (quiet stretches barely count)";
+const QString ADD_TO_FEATURE_BUTTON = "Add to Feature...";
+const QString ADD_TO_FEATURE_PROMPT = "Add the selected files to:";
+const QString NO_UPDATABLE_FEATURES_MESSAGE = "No feature can be extended yet. Features created from now on can.";
+const QString REMOVE_FROM_FEATURE_BUTTON = "Remove from Feature...";
+const QString REMOVE_FROM_FEATURE_PROMPT = "Remove the selected files from:";
+const QString REMOVE_FROM_FEATURE_FAILED_MESSAGE = "None of the selected files could be removed. A feature keeps at least one file.";
 const QString PROCESS_BUTTON = "Process";
-const QString SELECT_FEATURE_LABEL = "Select Sound Feature:";
+const QString SEPARATION_TIER_LABEL = "Quality tier:";
+const QString INT8_INFERENCE_CHECKBOX = "Faster INT8 inference (slightly lower quality)";
+const QString BF16_INFERENCE_CHECKBOX = "bfloat16 inference (faster on CPUs with bf16 support)";
+const QString SIMILARITY_GATE_CHECKBOX = "Only separate regions that sound like the feature (faster on long recordings)";
+const QString SELECT_FEATURE_LABEL = "Select Sound Feature(s):";
 const QString PROCESSED_FILES_LABEL = "Processed Files:";
 const QString DELETE_BUTTON = "Delete";
 
@@ -39,7 +51,8 @@ const QString REMOVE_FILE_TOOLTIP = "移除此檔案";
 
 // File Extensions
 const QString WAV_EXTENSION = ".wav";
-const QString TXT_EXTENSION = ".txt";
+const QString TXT_EXTENSION = ".txt";      // Legacy text features, still readable
+const QString FEATURE_EXTENSION = ".feat";  // Binary, memory-mappable features (FeatureStore)
 
 // UI Sizes
 const int SIDEBAR_WIDTH = 200;
@@ -59,6 +72,9 @@ const int PROGRESS_RANGE_MAX = 100;
 const QString OUTPUT_FEATURES_DIR = "output_features";       // Sound feature embeddings
 const QString SEPARATED_RESULT_DIR = "separated_results";     // Separation results
 const QString TEMP_SEGMENTS_DIR = "temp_chunks";             // Temporary chunks during processing
+const QString MODEL_CACHE_DIR = "model_cache";                // Frozen, inference-optimized TorchScript modules
+const QString EMBEDDING_CACHE_DIR = "embedding_cache";        // Per-file reference embeddings, keyed by content hash
+const int EMBEDDING_CACHE_VERSION = 1;                        // Bump when decoding or windowing changes the embeddings
 
 // Model file paths (absolute paths for development)
 const QString HTSAT_MODEL_PATH = "/home/mark/AudioSeparationTool/models/htsat_embedding_model.pt";              // HTSAT model folder
@@ -68,10 +84,53 @@ const QString ZERO_SHOT_ASP_MODEL_PATH = "/home/mark/AudioSeparationTool/models/
 const QString HTSAT_MODEL_RESOURCE = ":/models/htsat_embedding_model.pt";              // HTSAT model resource path
 const QString ZERO_SHOT_ASP_MODEL_RESOURCE = ":/models/zero_shot_asp_separation_model.pt"; // ZeroShotASP model resource path
 
+// Dynamically quantized (INT8) model variants, exported with quantize_models.py
+const QString HTSAT_INT8_MODEL_PATH = "/home/mark/AudioSeparationTool/models/htsat_embedding_model_int8.pt";
+const QString ZERO_SHOT_ASP_INT8_MODEL_PATH = "/home/mark/AudioSeparationTool/models/zero_shot_asp_separation_model_int8.pt";
+const QString HTSAT_INT8_MODEL_RESOURCE = ":/models/htsat_embedding_model_int8.pt";
+const QString ZERO_SHOT_ASP_INT8_MODEL_RESOURCE = ":/models/zero_shot_asp_separation_model_int8.pt";
+const int PRECISION_BENCHMARK_RUNS = 3;      // Timed forwards per precision when comparing against float32
+const double BF16_MIN_SNR_DB = 30.0;         // bf16 is refused if its separated output falls below this SNR vs float32
+const double BF16_MIN_EMBEDDING_COSINE = 0.995; // ... or its HTSAT embedding drifts below this cosine similarity
+
 // Audio processing constants
 const int AUDIO_SAMPLE_RATE = 32000;        // Sample rate in Hz
 const int AUDIO_CLIP_SAMPLES = 320000;      // Number of samples per clip (10 seconds @ 32kHz)
 const float AUDIO_OVERLAP_RATE = 0.5f;      // Overlap rate for overlap-add processing
+const int SEPARATION_BATCH_SIZE = 4;        // Default number of chunks stacked into one separation forward call
+const float DRAFT_OVERLAP_RATE = 0.25f;     // "draft" tier: fewer, less redundant chunks
+const int DRAFT_BATCH_SIZE = 8;
+const float ARCHIVAL_OVERLAP_RATE = 0.75f;  // "archival" tier: 4x chunk redundancy for smoother crossfades
+const int STREAMING_THRESHOLD_SECONDS = 600; // Inputs longer than this are separated in bounded-memory streaming mode
+const int PIPELINE_QUEUE_DEPTH = 2;          // Files buffered between the separation decode, inference and write stages
+const int EMBEDDING_BATCH_SIZE = 8;         // Reference clips stacked into one HTSAT forward call when building features
+const int EMBEDDING_DECODE_THREADS = 2;     // Minimum threads decoding reference files while HTSAT runs
+const float EMBEDDING_WINDOW_OVERLAP = 0.5f; // Overlap between the 10 s windows tiling a full-length reference
+const int EMBEDDING_MAX_WINDOWS = 32;       // Longer references are sampled uniformly down to this many windows
+const int SEPARATION_THREADS_PER_WORKER = 4;  // Intra-op threads per separation worker when the thread count is automatic
+const int DEFAULT_INTEROP_THREADS = 1;      // Frozen graphs have little inter-op parallelism; keep the cores for intra-op
+const int DEFAULT_DSP_THREADS = 1;          // Cores kept out of the inference budget for decode/resample/write stages
+
+// Thread budget overrides (environment; --threads, --interop-threads, --dsp-threads on the command line win)
+const char* const ENV_NUM_THREADS = "AST_NUM_THREADS";
+const char* const ENV_INTEROP_THREADS = "AST_INTEROP_THREADS";
+const char* const ENV_DSP_THREADS = "AST_DSP_THREADS";
+
+// Model registry RAM budget (environment; --model-memory-mb on the command line wins)
+const char* const ENV_MODEL_MEMORY_MB = "AST_MODEL_MEMORY_MB";
+const qint64 DEFAULT_MODEL_MEMORY_MB = 0;   // 0 = keep every loaded model resident
+
+// Inference backend (environment; --backend, --reference-embed-ms, --reference-separate-ms on the command line win)
+const char* const ENV_INFERENCE_BACKEND = "AST_INFERENCE_BACKEND";         // "torchscript" (default) or "reference"
+const char* const ENV_REFERENCE_EMBED_MS = "AST_REFERENCE_EMBED_MS";
+const char* const ENV_REFERENCE_SEPARATE_MS = "AST_REFERENCE_SEPARATE_MS";
+const double DEFAULT_REFERENCE_EMBED_MS = 0.0;     // Simulated single-core cost per embedded clip
+const double DEFAULT_REFERENCE_SEPARATE_MS = 0.0;  // Simulated single-core cost per separated chunk and query
+const int EMBEDDING_DIM = 2048;             // HTSAT latent size; also the separation model's condition size
+const float SILENCE_GATE_RMS = 1e-4f;       // Chunks below this RMS (about -80 dBFS)...
+const float SILENCE_GATE_PEAK = 1e-3f;      // ...and below this peak (-60 dBFS) skip separation inference
+const float SIMILARITY_GATE_THRESHOLD = 0.3f;   // Minimum HTSAT cosine similarity for a region to be separated
+const int SIMILARITY_GATE_NEIGHBOURHOOD = 1;    // Similar probe windows also keep this many probes on each side
 
 // Debug announcement constants
 const QString DEBUG_FILE_SELECTED = "Debug: File selected - %1";
@@ -0,0 +1,108 @@
+#include "embeddingcache.h"
+#include "constants.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+const quint32 ENTRY_MAGIC = 0x41535445; // "ASTE"
+const quint32 ENTRY_VERSION = 1;
+const qint64 HEADER_BYTES = 3 * sizeof(quint32);
+}
+
+EmbeddingCache& EmbeddingCache::instance()
+{
+    static EmbeddingCache cache;
+    return cache;
+}
+
+QString EmbeddingCache::contentHash(const QString& filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.exists()) {
+        return QString();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_hashes.find(info.absoluteFilePath());
+        if (it != m_hashes.end() && it->second.size == info.size() && it->second.modified == info.lastModified()) {
+            return it->second.hash;
+        }
+    }
+
+    // Hash outside the lock: decoder threads hash different files at the same time
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "EmbeddingCache: cannot read" << filePath;
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&file)) {
+        return QString();
+    }
+
+    HashedFile hashed;
+    hashed.size = info.size();
+    hashed.modified = info.lastModified();
+    hashed.hash = QString::fromLatin1(hash.result().toHex());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hashes[info.absoluteFilePath()] = hashed;
+    return hashed.hash;
+}
+
+QString EmbeddingCache::keyFor(const QString& contentHash, const QString& modelVersion, const QString& preprocessing)
+{
+    const QByteArray parts = QString("%1|%2|%3|v%4").arg(contentHash, modelVersion, preprocessing)
+                                 .arg(Constants::EMBEDDING_CACHE_VERSION).toUtf8();
+    return QString::fromLatin1(QCryptographicHash::hash(parts, QCryptographicHash::Sha256).toHex());
+}
+
+QString EmbeddingCache::pathFor(const QString& key)
+{
+    return QString("%1/%2.emb").arg(Constants::EMBEDDING_CACHE_DIR, key);
+}
+
+bool EmbeddingCache::lookup(const QString& key, std::vector<float>& embedding) const
+{
+    QFile file(pathFor(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    if (data.size() < HEADER_BYTES) {
+        return false;
+    }
+
+    quint32 header[3];
+    std::memcpy(header, data.constData(), HEADER_BYTES);
+    const qint64 dim = header[2];
+    if (header[0] != ENTRY_MAGIC || header[1] != ENTRY_VERSION
+        || data.size() != HEADER_BYTES + dim * static_cast<qint64>(sizeof(float))) {
+        qDebug() << "EmbeddingCache: ignoring damaged entry" << pathFor(key);
+        return false;
+    }
+
+    embedding.resize(dim);
+    std::memcpy(embedding.data(), data.constData() + HEADER_BYTES, dim * sizeof(float));
+    return true;
+}
+
+bool EmbeddingCache::store(const QString& key, const std::vector<float>& embedding)
+{
+    QDir().mkpath(Constants::EMBEDDING_CACHE_DIR);
+    // QSaveFile: a half-written entry never replaces a good one
+    QSaveFile file(pathFor(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "EmbeddingCache: cannot write" << pathFor(key);
+        return false;
+    }
+    const quint32 header[3] = {ENTRY_MAGIC, ENTRY_VERSION, static_cast<quint32>(embedding.size())};
+    file.write(reinterpret_cast<const char*>(header), HEADER_BYTES);
+    file.write(reinterpret_cast<const char*>(embedding.data()), embedding.size() * sizeof(float));
+    return file.commit();
+}
@@ -0,0 +1,64 @@
+#ifndef EMBEDDINGCACHE_H
+#define EMBEDDINGCACHE_H
+
+#include <QDateTime>
+#include <QString>
+#include <QtGlobal>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Persistent per-file cache of reference embeddings.
+ *
+ * Entries are keyed by a hash of the audio file's bytes together with the
+ * embedding model version and the preprocessing settings, so a renamed or
+ * copied file still hits and a changed file, model or window setting misses.
+ * Each entry is one small file in Constants::EMBEDDING_CACHE_DIR. Safe to use
+ * from several threads.
+ */
+class EmbeddingCache
+{
+public:
+    static EmbeddingCache& instance();
+
+    /**
+     * @brief MD5 of the file's contents, hex encoded; empty if it cannot be read.
+     *
+     * Remembered per path, size and modification time for the session, so
+     * unchanged files are hashed once.
+     */
+    QString contentHash(const QString& filePath);
+
+    /**
+     * @brief Cache key for a file hash embedded by `modelVersion` with `preprocessing` settings.
+     */
+    static QString keyFor(const QString& contentHash, const QString& modelVersion, const QString& preprocessing);
+
+    /**
+     * @brief Reads the embedding stored under `key`.
+     * @return False on a miss or a damaged entry.
+     */
+    bool lookup(const QString& key, std::vector<float>& embedding) const;
+
+    /**
+     * @brief Stores an embedding; an existing entry for `key` is replaced.
+     */
+    bool store(const QString& key, const std::vector<float>& embedding);
+
+private:
+    EmbeddingCache() = default;
+
+    static QString pathFor(const QString& key);
+
+    struct HashedFile {
+        qint64 size = -1;
+        QDateTime modified;
+        QString hash;
+    };
+
+    std::mutex m_mutex;                        ///< Guards m_hashes
+    std::map<QString, HashedFile> m_hashes;    ///< Path -> last computed content hash
+};
+
+#endif // EMBEDDINGCACHE_H
@@ -0,0 +1,400 @@
+#include "featurestore.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+const quint32 MEMBERS_MAGIC = 0x4153544D; // "ASTM"
+const quint32 MEMBERS_VERSION = 1;
+
+const char FEATURE_MAGIC[4] = {'A', 'S', 'T', 'F'};
+const quint32 FEATURE_VERSION = 1;
+const quint32 FEATURE_DTYPE_FLOAT32 = 0;
+const quint32 FEATURE_DATA_ALIGNMENT = 64;  // Data offset; rows start on a 64-byte boundary in the file
+
+/**
+ * @brief Fixed part of a .feat file, written in host byte order (little-endian on every supported platform).
+ *
+ * The UTF-8 model version follows it; zero padding then runs up to dataOffset.
+ */
+struct FeatureFileHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 dataOffset;
+    quint32 dtype;
+    quint32 dimension;
+    quint32 rows;
+    quint32 memberCount;
+    quint32 checksum;           ///< CRC-32 of the data section
+    quint32 modelVersionBytes;
+};
+static_assert(sizeof(FeatureFileHeader) == 36, "FeatureFileHeader must stay packed");
+
+quint32 crc32(const uchar* data, qint64 size)
+{
+    static const std::vector<quint32> table = [] {
+        std::vector<quint32> t(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    quint32 crc = 0xFFFFFFFFu;
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool isLegacyText(const QString& featurePath)
+{
+    return QFileInfo(featurePath).suffix().compare(Constants::TXT_EXTENSION.mid(1), Qt::CaseInsensitive) == 0;
+}
+
+/**
+ * @brief Parses the old whitespace-separated text format into a (1, dimension) tensor.
+ */
+torch::Tensor loadTextFeature(const QString& featurePath, QString* errorMessage)
+{
+    QFile file(featurePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorMessage) *errorMessage = QString("Failed to open feature file: %1").arg(featurePath);
+        return torch::Tensor();
+    }
+
+    const QStringList parts = QString::fromUtf8(file.readAll())
+                                  .split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    std::vector<float> values;
+    values.reserve(parts.size());
+    for (const QString& part : parts) {
+        bool ok = false;
+        const float value = part.toFloat(&ok);
+        if (!ok) {
+            if (errorMessage) *errorMessage = QString("Invalid float value in feature file: %1").arg(part);
+            return torch::Tensor();
+        }
+        values.push_back(value);
+    }
+    if (values.empty()) {
+        if (errorMessage) *errorMessage = QString("Feature file is empty or invalid format: %1").arg(featurePath);
+        return torch::Tensor();
+    }
+    return torch::from_blob(values.data(), {1, static_cast<int64_t>(values.size())}, torch::kFloat).clone();
+}
+
+} // namespace
+
+std::vector<float> FeatureRecord::mean() const
+{
+    if (members.empty()) {
+        return std::vector<float>();
+    }
+    std::vector<double> sum(members.front().embedding.size(), 0.0);
+    for (const FeatureMember& member : members) {
+        for (size_t i = 0; i < sum.size() && i < member.embedding.size(); ++i) {
+            sum[i] += member.embedding[i];
+        }
+    }
+    std::vector<float> result(sum.size());
+    for (size_t i = 0; i < sum.size(); ++i) {
+        result[i] = static_cast<float>(sum[i] / members.size());
+    }
+    return result;
+}
+
+int FeatureRecord::indexOf(const QString& filePath) const
+{
+    const QString absolutePath = QFileInfo(filePath).absoluteFilePath();
+    for (size_t i = 0; i < members.size(); ++i) {
+        if (members[i].filePath == absolutePath) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+namespace FeatureStore {
+
+QStringList featureFileFilters()
+{
+    return QStringList() << "*" + Constants::FEATURE_EXTENSION << "*" + Constants::TXT_EXTENSION;
+}
+
+QString featurePathFor(const QString& featureName)
+{
+    const QString binaryPath = QString("%1/%2%3").arg(Constants::OUTPUT_FEATURES_DIR, featureName,
+                                                      Constants::FEATURE_EXTENSION);
+    const QString textPath = QString("%1/%2%3").arg(Constants::OUTPUT_FEATURES_DIR, featureName,
+                                                    Constants::TXT_EXTENSION);
+    if (!QFile::exists(binaryPath) && QFile::exists(textPath)) {
+        return textPath;
+    }
+    return binaryPath;
+}
+
+QString binaryPathFor(const QString& featurePath)
+{
+    const QFileInfo info(featurePath);
+    return info.path() + "/" + info.completeBaseName() + Constants::FEATURE_EXTENSION;
+}
+
+bool writeFeatureFile(const QString& featurePath, const std::vector<std::vector<float>>& rows,
+                      const QString& modelVersion, quint32 memberCount)
+{
+    if (rows.empty() || rows.front().empty()) {
+        qDebug() << "FeatureStore: refusing to write an empty feature" << featurePath;
+        return false;
+    }
+    const size_t dimension = rows.front().size();
+    QByteArray data;
+    data.reserve(static_cast<int>(rows.size() * dimension * sizeof(float)));
+    for (const std::vector<float>& row : rows) {
+        if (row.size() != dimension) {
+            qDebug() << "FeatureStore: rows of different lengths in" << featurePath;
+            return false;
+        }
+        data.append(reinterpret_cast<const char*>(row.data()), static_cast<int>(dimension * sizeof(float)));
+    }
+
+    const QByteArray version = modelVersion.toUtf8();
+    FeatureFileHeader header = {};
+    std::memcpy(header.magic, FEATURE_MAGIC, sizeof(header.magic));
+    header.version = FEATURE_VERSION;
+    header.dtype = FEATURE_DTYPE_FLOAT32;
+    header.dimension = static_cast<quint32>(dimension);
+    header.rows = static_cast<quint32>(rows.size());
+    header.memberCount = memberCount;
+    header.checksum = crc32(reinterpret_cast<const uchar*>(data.constData()), data.size());
+    header.modelVersionBytes = static_cast<quint32>(version.size());
+    const quint32 used = sizeof(FeatureFileHeader) + header.modelVersionBytes;
+    header.dataOffset = (used + FEATURE_DATA_ALIGNMENT - 1) / FEATURE_DATA_ALIGNMENT * FEATURE_DATA_ALIGNMENT;
+
+    QSaveFile file(featurePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "FeatureStore: cannot write" << featurePath;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(version);
+    file.write(QByteArray(static_cast<int>(header.dataOffset - used), '\0'));
+    file.write(data);
+    return file.commit();
+}
+
+torch::Tensor loadFeatureTensor(const QString& featurePath, QString* errorMessage, FeatureFileInfo* info)
+{
+    const QFileInfo fi(featurePath);
+    if (!fi.exists() || !fi.isReadable()) {
+        if (errorMessage) *errorMessage = QString("Feature file does not exist or is not readable: %1").arg(featurePath);
+        return torch::Tensor();
+    }
+    if (isLegacyText(featurePath)) {
+        torch::Tensor tensor = loadTextFeature(featurePath, errorMessage);
+        if (tensor.defined() && info) {
+            *info = FeatureFileInfo();
+            info->dimension = static_cast<int>(tensor.size(1));
+            info->rows = 1;
+            info->legacyText = true;
+        }
+        return tensor;
+    }
+
+    // A feature is a few KB, so it is read whole and the file closed right away;
+    // a mapping would keep it locked on Windows while the tensor lives
+    QFile file(featurePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) *errorMessage = QString("Failed to open feature file: %1").arg(featurePath);
+        return torch::Tensor();
+    }
+    const QByteArray contents = file.readAll();
+    file.close();
+    const qint64 size = contents.size();
+    FeatureFileHeader header = {};
+    if (size >= static_cast<qint64>(sizeof(header))) {
+        std::memcpy(&header, contents.constData(), sizeof(header));
+    }
+    if (size < static_cast<qint64>(sizeof(header))
+        || std::memcmp(header.magic, FEATURE_MAGIC, sizeof(header.magic)) != 0) {
+        if (errorMessage) *errorMessage = QString("Not a feature file: %1").arg(featurePath);
+        return torch::Tensor();
+    }
+    const qint64 dataBytes = static_cast<qint64>(header.rows) * header.dimension * sizeof(float);
+    if (header.version != FEATURE_VERSION || header.dtype != FEATURE_DTYPE_FLOAT32
+        || header.dataOffset % FEATURE_DATA_ALIGNMENT != 0
+        || header.dataOffset < sizeof(header) + header.modelVersionBytes
+        || header.rows == 0 || header.dimension == 0 || size != header.dataOffset + dataBytes) {
+        if (errorMessage) *errorMessage = QString("Unsupported or truncated feature file: %1").arg(featurePath);
+        return torch::Tensor();
+    }
+
+    const uchar* bytes = reinterpret_cast<const uchar*>(contents.constData());
+    if (crc32(bytes + header.dataOffset, dataBytes) != header.checksum) {
+        if (errorMessage) *errorMessage = QString("Feature file checksum mismatch: %1").arg(featurePath);
+        return torch::Tensor();
+    }
+
+    if (info) {
+        info->modelVersion = QString::fromUtf8(reinterpret_cast<const char*>(bytes) + sizeof(header),
+                                               static_cast<int>(header.modelVersionBytes));
+        info->dimension = static_cast<int>(header.dimension);
+        info->rows = static_cast<int>(header.rows);
+        info->memberCount = header.memberCount;
+        info->legacyText = false;
+    }
+
+    const std::vector<int64_t> shape = {static_cast<int64_t>(header.rows), static_cast<int64_t>(header.dimension)};
+    return torch::from_blob(const_cast<uchar*>(bytes) + header.dataOffset, shape, torch::kFloat).clone();
+}
+
+int migrateTextFeatures(const QString& directory)
+{
+    QDir dir(directory);
+    int converted = 0;
+    const QStringList textFiles = dir.entryList(QStringList() << "*" + Constants::TXT_EXTENSION, QDir::Files);
+    for (const QString& name : textFiles) {
+        const QString textPath = dir.filePath(name);
+        const QString binaryPath = binaryPathFor(textPath);
+        if (QFile::exists(binaryPath)) {
+            continue;
+        }
+
+        QString errorMessage;
+        torch::Tensor text = loadFeatureTensor(textPath, &errorMessage);
+        if (!text.defined()) {
+            qDebug() << "FeatureStore: not migrating" << textPath << "-" << errorMessage;
+            continue;
+        }
+        std::vector<float> mean(text.data_ptr<float>(), text.data_ptr<float>() + text.numel());
+
+        // Members, when kept, know the model and how many files the mean covers
+        FeatureRecord record;
+        const bool hasMembers = loadMembers(textPath, &record);
+        if (!writeFeatureFile(binaryPath, {mean}, hasMembers ? record.modelVersion : QString(),
+                              hasMembers ? static_cast<quint32>(record.members.size()) : 0)) {
+            continue;
+        }
+        torch::Tensor binary = loadFeatureTensor(binaryPath);
+        if (!binary.defined() || !torch::equal(binary, text)) {
+            qDebug() << "FeatureStore: migrated" << textPath << "does not read back, keeping the text file";
+            QFile::remove(binaryPath);
+            continue;
+        }
+        retireTextFeature(textPath);
+        ++converted;
+    }
+    if (converted > 0) {
+        qDebug() << "FeatureStore: converted" << converted << "text feature(s) to" << Constants::FEATURE_EXTENSION;
+    }
+    return converted;
+}
+
+bool retireTextFeature(const QString& textPath)
+{
+    // Kept as a backup; an older backup of the same feature is replaced
+    const QString backupPath = textPath + ".bak";
+    QFile::remove(backupPath);
+    if (!QFile::rename(textPath, backupPath)) {
+        qDebug() << "FeatureStore: could not rename" << textPath << "- the .feat next to it takes precedence";
+        return false;
+    }
+    return true;
+}
+
+QString membersPathFor(const QString& featurePath)
+{
+    const QFileInfo info(featurePath);
+    return info.path() + "/" + info.completeBaseName() + ".members";
+}
+
+bool saveMembers(const QString& featurePath, const FeatureRecord& record)
+{
+    QSaveFile file(membersPathFor(featurePath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "FeatureStore: cannot write" << membersPathFor(featurePath);
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    out << MEMBERS_MAGIC << MEMBERS_VERSION << record.modelVersion
+        << static_cast<qint32>(record.options.coverage) << record.options.windowOverlap
+        << static_cast<qint32>(record.options.maxWindowsPerFile) << static_cast<qint32>(record.options.pooling)
+        << static_cast<quint32>(record.members.size());
+    for (const FeatureMember& member : record.members) {
+        out << member.filePath << member.contentHash << static_cast<quint32>(member.embedding.size());
+        for (float value : member.embedding) {
+            out << value;
+        }
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool loadMembers(const QString& featurePath, FeatureRecord* record, QString* errorMessage)
+{
+    QFile file(membersPathFor(featurePath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) *errorMessage = QString("No member embeddings saved for %1").arg(featurePath);
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    quint32 magic = 0, version = 0, count = 0;
+    qint32 coverage = 0, maxWindows = 0, pooling = 0;
+    FeatureRecord loaded;
+    in >> magic >> version;
+    if (magic != MEMBERS_MAGIC || version != MEMBERS_VERSION) {
+        if (errorMessage) *errorMessage = QString("Unsupported members file: %1").arg(membersPathFor(featurePath));
+        return false;
+    }
+    in >> loaded.modelVersion >> coverage >> loaded.options.windowOverlap >> maxWindows >> pooling >> count;
+    loaded.options.coverage = static_cast<EmbeddingCoverage>(coverage);
+    loaded.options.maxWindowsPerFile = maxWindows;
+    loaded.options.pooling = static_cast<WindowPooling>(pooling);
+
+    for (quint32 m = 0; m < count && in.status() == QDataStream::Ok; ++m) {
+        FeatureMember member;
+        quint32 dim = 0;
+        in >> member.filePath >> member.contentHash >> dim;
+        if (dim > static_cast<quint32>(Constants::EMBEDDING_DIM) * 4) {
+            break;
+        }
+        member.embedding.resize(dim);
+        for (quint32 i = 0; i < dim; ++i) {
+            in >> member.embedding[i];
+        }
+        loaded.members.push_back(std::move(member));
+    }
+    if (in.status() != QDataStream::Ok || loaded.members.size() != count) {
+        if (errorMessage) *errorMessage = QString("Damaged members file: %1").arg(membersPathFor(featurePath));
+        return false;
+    }
+
+    *record = std::move(loaded);
+    return true;
+}
+
+int removeMembers(FeatureRecord* record, const QStringList& filePaths)
+{
+    int removed = 0;
+    for (const QString& filePath : filePaths) {
+        const int index = record->indexOf(filePath);
+        if (index >= 0) {
+            record->members.erase(record->members.begin() + index);
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+} // namespace FeatureStore
@@ -0,0 +1,176 @@
+#ifndef FEATURESTORE_H
+#define FEATURESTORE_H
+
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "constants.h"
+
+#ifndef Q_MOC_RUN
+#undef slots
+#include <torch/torch.h>
+#define slots
+#endif
+
+/**
+ * @brief Which part of each reference file is embedded.
+ */
+enum class EmbeddingCoverage {
+    FirstClip,  ///< Only the first AUDIO_CLIP_SAMPLES (10 s); longer files are truncated
+    FullLength  ///< The whole file, tiled into overlapping 10 s windows
+};
+
+/**
+ * @brief How the window embeddings of one file are combined.
+ */
+enum class WindowPooling {
+    Mean,          ///< Every window counts the same
+    EnergyWeighted ///< Windows weighted by their RMS, so silent stretches barely count
+};
+
+/**
+ * @brief Settings for building a feature from reference files; stored with the feature.
+ */
+struct EmbeddingOptions
+{
+    EmbeddingCoverage coverage = EmbeddingCoverage::FullLength;
+    float windowOverlap = Constants::EMBEDDING_WINDOW_OVERLAP; ///< Overlap between consecutive windows (0 to 0.9)
+    int maxWindowsPerFile = Constants::EMBEDDING_MAX_WINDOWS;  ///< Cap per file; windows are sampled uniformly past it
+    WindowPooling pooling = WindowPooling::Mean;
+    bool useCache = true;  ///< Reuse embeddings of files seen before (EmbeddingCache)
+};
+Q_DECLARE_METATYPE(EmbeddingOptions)
+
+/**
+ * @brief One reference file of a feature and its embedding.
+ */
+struct FeatureMember
+{
+    QString filePath;
+    QString contentHash;           ///< EmbeddingCache::contentHash() when the file was embedded
+    std::vector<float> embedding;  ///< (EMBEDDING_DIM)
+};
+
+/**
+ * @brief Everything a saved feature was built from: its member embeddings and how they were made.
+ *
+ * The query vector used for separation is the mean of the members, so files
+ * can be added or removed later by embedding only the difference.
+ */
+struct FeatureRecord
+{
+    QString modelVersion;          ///< HTSATProcessor::modelVersion() of the embedding model
+    EmbeddingOptions options;
+    std::vector<FeatureMember> members;
+
+    /**
+     * @brief Mean of the member embeddings, accumulated in double; empty if there are no members.
+     */
+    std::vector<float> mean() const;
+
+    /**
+     * @brief Index of the member for `filePath`, or -1.
+     */
+    int indexOf(const QString& filePath) const;
+};
+Q_DECLARE_METATYPE(FeatureRecord)
+
+/**
+ * @brief Header fields of a saved feature file.
+ */
+struct FeatureFileInfo
+{
+    QString modelVersion;     ///< Empty for legacy text features
+    int dimension = 0;
+    int rows = 0;             ///< Vectors stored; a feature mean is one row
+    quint32 memberCount = 0;  ///< Reference files averaged into the feature; 0 if unknown
+    bool legacyText = false;  ///< Read from the old whitespace-separated .txt format
+};
+
+/**
+ * @brief Feature files and the member embeddings saved next to them.
+ *
+ * Features are written as output_features/<name>.feat: a small versioned
+ * header (dtype, dimension, rows, member count, model version, CRC-32 of the
+ * data) followed by raw float32 rows at a 64-byte aligned offset, so a feature
+ * loads with one read and a CRC check instead of text parsing.
+ * Features saved before that as whitespace-separated .txt stay readable and
+ * are converted by migrateTextFeatures().
+ *
+ * For output_features/dog_20240101_120000.feat the members live in
+ * output_features/dog_20240101_120000.members. Features saved before members
+ * were kept have no such file and can only be rebuilt, not updated.
+ */
+namespace FeatureStore {
+
+/**
+ * @brief Name filters matching feature files in either format.
+ */
+QStringList featureFileFilters();
+
+/**
+ * @brief Saved feature file for a feature name: the .feat file, else a legacy .txt, else the .feat path to create.
+ */
+QString featurePathFor(const QString& featureName);
+
+/**
+ * @brief Path a feature is rewritten to; a legacy .txt path maps to the .feat next to it.
+ */
+QString binaryPathFor(const QString& featurePath);
+
+/**
+ * @brief Writes a feature file in the binary format; a half-written file never replaces a good one.
+ * @param rows Vectors of equal length, normally just the feature mean.
+ */
+bool writeFeatureFile(const QString& featurePath, const std::vector<std::vector<float>>& rows,
+                      const QString& modelVersion, quint32 memberCount);
+
+/**
+ * @brief Loads a feature file as a float32 tensor of shape (rows, dimension).
+ *
+ * Binary files are read whole and closed before returning, so the file can be
+ * rewritten or deleted while the tensor is in use. Legacy .txt files are parsed.
+ * @return Undefined tensor on failure; `errorMessage` says why.
+ */
+torch::Tensor loadFeatureTensor(const QString& featurePath, QString* errorMessage = nullptr,
+                                FeatureFileInfo* info = nullptr);
+
+/**
+ * @brief Converts every legacy .txt feature in `directory` to .feat and renames the .txt to .txt.bak.
+ *
+ * A feature is only renamed once its .feat reads back the same; the members
+ * file keeps its name, so converted features stay updatable. Called once at
+ * startup, before the feature lists are built.
+ * @return Number of features converted.
+ */
+int migrateTextFeatures(const QString& directory);
+
+/**
+ * @brief Renames a legacy .txt feature that now has a .feat to .txt.bak, which the feature lists ignore.
+ * @return False if the file could not be renamed; the .feat next to it still takes precedence.
+ */
+bool retireTextFeature(const QString& textPath);
+
+QString membersPathFor(const QString& featurePath);
+
+/**
+ * @brief Writes the members file for a feature; a half-written file never replaces a good one.
+ */
+bool saveMembers(const QString& featurePath, const FeatureRecord& record);
+
+/**
+ * @brief Reads the members file of a feature.
+ * @return False if there is none or it is damaged; `errorMessage` says which.
+ */
+bool loadMembers(const QString& featurePath, FeatureRecord* record, QString* errorMessage = nullptr);
+
+/**
+ * @brief Drops the members whose paths are listed.
+ * @return Number of members removed.
+ */
+int removeMembers(FeatureRecord* record, const QStringList& filePaths);
+
+} // namespace FeatureStore
+
+#endif // FEATURESTORE_H
@@ -1,40 +1,82 @@
 #include "htsatprocessor.h"
 #include "constants.h"
+#include "modelregistry.h"
+#include "embeddingcache.h"
+#include "referencebackend.h"
 #include <torch/script.h>
 #include <torch/torch.h>
 #include <QString>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QMap>
 #include <QResource>
-#include <QTemporaryFile>
-#include <QFile>
+#include <mutex>
 #include <sndfile.h>
 #include <samplerate.h>
 
+namespace {
+
+/**
+ * @brief MD5 of a model file or resource, hex encoded; empty if it cannot be read.
+ *
+ * Files share EmbeddingCache's per-session memo; resources cannot change while
+ * the app runs, so each is hashed once.
+ */
+QString modelContentHash(const QString& source)
+{
+    if (!source.startsWith(":/")) {
+        return EmbeddingCache::instance().contentHash(source);
+    }
+
+    static std::mutex mutex;
+    static QMap<QString, QString> resourceHashes;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = resourceHashes.constFind(source);
+    if (it != resourceHashes.constEnd()) {
+        return it.value();
+    }
+    QResource resource(source);
+    if (!resource.isValid()) {
+        return QString();
+    }
+    const QByteArray data = resource.compressionAlgorithm() == QResource::NoCompression
+        ? QByteArray::fromRawData(reinterpret_cast<const char*>(resource.data()), static_cast<int>(resource.size()))
+        : resource.uncompressedData();
+    const QString hash = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex());
+    resourceHashes.insert(source, hash);
+    return hash;
+}
+
+} // namespace
+
 /**
  * @brief Constructs the HTSATProcessor.
  * @param parent The parent QObject (default is nullptr).
  */
 HTSATProcessor::HTSATProcessor(QObject *parent)
-    : QObject(parent), modelLoaded(false)
+    : QObject(parent), modelLoaded(false), modelDtype(torch::kFloat)
 {
 }
 
 /**
- * @brief Loads the TorchScript model from the specified path.
- * @param modelPath Path to the TorchScript model file (e.g., "htsat_embedding_model.pt").
+ * @brief Loads the model from the specified path with the current inference backend.
+ * @param modelPath Path to the TorchScript model file (e.g., "htsat_embedding_model.pt"); unused by the reference backend.
+ * @param dtype Parameter dtype; torch::kBFloat16 runs inference in bf16. Embeddings are always float32.
  * @return True if loading succeeded, false otherwise.
  */
-bool HTSATProcessor::loadModel(const QString& modelPath)
+bool HTSATProcessor::loadModel(const QString& modelPath, torch::ScalarType dtype)
 {
-    try {
-        model = torch::jit::load(modelPath.toStdString());
-        model.eval();
-        modelLoaded = true;
-        return true;
-    } catch (const c10::Error& e) {
-        emit errorOccurred(QString("Error loading model: %1").arg(e.what()));
+    QString errorMessage;
+    backend = InferenceBackends::openEmbedding(modelPath, dtype, &errorMessage);
+    if (!backend) {
+        emit errorOccurred(QString("Error loading model: %1").arg(errorMessage));
         modelLoaded = false;
+        return false;
     }
+    modelSource = modelPath;
+    modelDtype = dtype;
+    modelLoaded = true;
+    return true;
 }
 
 /**
@@ -110,13 +152,9 @@ std::vector<float> HTSATProcessor::processTensor(const torch::Tensor& audioTenso
 
     qDebug() << "HTSATProcessor::processTensor - Final tensor shape: [" << tensor.size(0) << "," << tensor.size(1) << "]";
 
-    std::vector<torch::jit::IValue> inputs;
-    inputs.push_back(tensor);
-
     try {
         qDebug() << "HTSATProcessor::processTensor - Starting model inference...";
-        auto output_dict = model.forward(inputs).toGenericDict();
-        torch::Tensor output = output_dict.at("latent_output").toTensor();
+        torch::Tensor output = backend->embed(tensor.to(torch::kFloat)).contiguous();
 
         qDebug() << "HTSATProcessor::processTensor - Model inference successful";
         qDebug() << "HTSATProcessor::processTensor - Output shape: [" << output.size(0) << "," << output.size(1) << "]";
@@ -138,6 +176,43 @@ std::vector<float> HTSATProcessor::processTensor(const torch::Tensor& audioTenso
     }
 }
 
+/**
+ * @brief Embeds a batch of clips in a single forward call.
+ * @param clips Audio clips of shape (B, samples), mono 32kHz; padded or truncated to AUDIO_CLIP_SAMPLES.
+ * @return Embeddings of shape (B, 2048), or an undefined tensor on failure.
+ */
+torch::Tensor HTSATProcessor::processBatch(const torch::Tensor& clips)
+{
+    if (!modelLoaded) {
+        emit errorOccurred("Model not loaded.");
+        return torch::Tensor();
+    }
+    if (clips.dim() != 2 || clips.size(0) == 0) {
+        emit errorOccurred("processBatch expects clips of shape (B, samples)");
+        return torch::Tensor();
+    }
+
+    const int64_t expectedLength = Constants::AUDIO_CLIP_SAMPLES;
+    torch::Tensor tensor = clips.to(torch::kFloat);
+    if (tensor.size(1) < expectedLength) {
+        tensor = torch::constant_pad_nd(tensor, {0, expectedLength - tensor.size(1)}, 0);
+    } else if (tensor.size(1) > expectedLength) {
+        tensor = tensor.narrow(1, 0, expectedLength);
+    }
+
+    try {
+        return backend->embed(tensor);
+    } catch (const c10::Error& e) {
+        qDebug() << "HTSATProcessor::processBatch - Model inference error:" << e.what();
+        emit errorOccurred(QString("Model inference error: %1").arg(e.what()));
+        return torch::Tensor();
+    } catch (const std::exception& e) {
+        qDebug() << "HTSATProcessor::processBatch - Standard exception:" << e.what();
+        emit errorOccurred(QString("Processing error: %1").arg(e.what()));
+        return torch::Tensor();
+    }
+}
+
 /**
  * @brief Processes an audio file to generate an embedding.
  * @param audioPath Path to the audio file (WAV format).
@@ -160,52 +235,41 @@ bool HTSATProcessor::isModelLoaded() const
 }
 
 
-bool HTSATProcessor::loadModelFromResource(const QString& resourcePath)
+bool HTSATProcessor::loadModelFromResource(const QString& resourcePath, torch::ScalarType dtype)
 {
-    QResource resource(resourcePath);
-    if (!resource.isValid()) {
-        emit errorOccurred(QString("Invalid resource path: %1").arg(resourcePath));
+    QString errorMessage;
+    backend = InferenceBackends::openEmbedding(resourcePath, dtype, &errorMessage);
+    if (!backend) {
+        emit errorOccurred(QString("Error loading model from resource: %1").arg(errorMessage));
+        modelLoaded = false;
         return false;
     }
 
-    QTemporaryFile tempFile;
-    tempFile.setAutoRemove(false);
-    
-    if (!tempFile.open()) {
-        emit errorOccurred("Failed to create temporary file for model");
-        return false;
-    }
+    modelSource = resourcePath;
+    modelDtype = dtype;
+    modelLoaded = true;
+    qDebug() << "Successfully loaded" << backend->name() << "model from resource:" << resourcePath;
+    return true;
+}
 
-    QByteArray data = resource.uncompressedData();
-    if (data.isEmpty()) {
-        emit errorOccurred("Resource data is empty");
-        return false;
-    }
+QString HTSATProcessor::registryKey() const
+{
+    return modelLoaded ? ModelRegistry::keyFor(modelSource, modelDtype) : QString();
+}
 
-    qint64 bytesWritten = tempFile.write(data);
-    if (bytesWritten != data.size()) {
-        emit errorOccurred("Failed to write complete model data to temporary file");
-        tempFile.close();
-        return false;
+QString HTSATProcessor::modelVersion() const
+{
+    if (!modelLoaded) {
+        return QString();
     }
+    return modelVersionFor(modelSource, modelDtype, std::dynamic_pointer_cast<ReferenceEmbeddingBackend>(backend) != nullptr);
+}
 
-    tempFile.close();
-
-    try {
-        model = torch::jit::load(tempFile.fileName().toStdString());
-        model.eval();
-        modelLoaded = true;
-        
-        QFile::remove(tempFile.fileName());
-        
-        qDebug() << "Successfully loaded model from resource:" << resourcePath;
-        return true;
-    } catch (const c10::Error& e) {
-        emit errorOccurred(QString("Error loading model from resource: %1").arg(e.what()));
-        modelLoaded = false;
-        
-        QFile::remove(tempFile.fileName());
-        
-        return false;
-    }
+QString HTSATProcessor::modelVersionFor(const QString& source, torch::ScalarType dtype, bool reference)
+{
+    // Keyed on the model's bytes, not its path or timestamp: a copied, moved or
+    // touched model still matches, a retrained one of the same size does not.
+    // The reference backend never reads the file.
+    const QString version = QString("%1@%2").arg(reference ? "reference" : "TorchScript", QString(c10::toString(dtype)));
+    return reference ? version : version + ":" + modelContentHash(source);
 }
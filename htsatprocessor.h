@@ -10,11 +10,13 @@
 #define slots
 #endif
 #include <vector>
+#include "inferencebackend.h"
 
 /**
  * @brief Class for handling HTSAT (Hierarchical Token-Semantic Audio Transformer) model processing.
  *
- * This class loads TorchScript models and processes preprocessed audio tensors to generate embeddings.
+ * This class opens the embedding model through the selected InferenceBackends backend and processes
+ * preprocessed audio tensors to generate embeddings.
  */
 class HTSATProcessor : public QObject
 {
@@ -28,12 +30,13 @@ public:
     explicit HTSATProcessor(QObject *parent = nullptr);
 
     /**
-     * @brief Loads the TorchScript model from the specified path.
-     * @param modelPath Path to the TorchScript model file (e.g., "htsat_embedding_model.pt").
+     * @brief Loads the model from the specified path with the current inference backend.
+     * @param modelPath Path to the TorchScript model file (e.g., "htsat_embedding_model.pt"); unused by the reference backend.
+     * @param dtype Parameter dtype; torch::kBFloat16 runs inference in bf16. Embeddings are always float32.
      * @return True if loading succeeded, false otherwise.
      */
-    bool loadModel(const QString& modelPath);
-    bool loadModelFromResource(const QString& resourcePath);
+    bool loadModel(const QString& modelPath, torch::ScalarType dtype = torch::kFloat);
+    bool loadModelFromResource(const QString& resourcePath, torch::ScalarType dtype = torch::kFloat);
 
     /**
      * @brief Processes an audio file to generate an embedding.
@@ -49,12 +52,39 @@ public:
      */
     std::vector<float> processTensor(const torch::Tensor& audioTensor);
 
+    /**
+     * @brief Embeds a batch of clips in a single forward call.
+     * @param clips Audio clips of shape (B, samples), mono 32kHz; padded or truncated to AUDIO_CLIP_SAMPLES.
+     * @return Embeddings of shape (B, 2048), or an undefined tensor on failure.
+     */
+    torch::Tensor processBatch(const torch::Tensor& clips);
+
     /**
      * @brief Checks if the model is loaded and ready for inference.
      * @return True if model is loaded, false otherwise.
      */
     bool isModelLoaded() const;
 
+    /**
+     * @brief Identifies the loaded model for caches of its outputs.
+     * @return Backend, dtype and an MD5 of the model's contents; empty if no model is loaded.
+     */
+    QString modelVersion() const;
+
+    /**
+     * @brief The modelVersion() a processor would report for a model, without loading it.
+     * @param source Model file or ":/..." resource path.
+     * @param dtype Parameter dtype.
+     * @param reference True for the reference backend, which never reads `source`.
+     */
+    static QString modelVersionFor(const QString& source, torch::ScalarType dtype, bool reference);
+
+    /**
+     * @brief Key of the loaded model in ModelRegistry, for releasing it once this processor is done.
+     * @return The key; empty if no model is loaded.
+     */
+    QString registryKey() const;
+
 signals:
     /**
      * @brief Emitted when an error occurs during processing.
@@ -69,8 +99,10 @@ signals:
     void processingFinished(const std::vector<float>& embedding);
 
 private:
-    torch::jit::script::Module model; ///< The loaded TorchScript model
-    bool modelLoaded;                 ///< Flag indicating if the model is loaded
+    std::shared_ptr<EmbeddingBackend> backend; ///< TorchScript (model shared through ModelRegistry) or reference
+    bool modelLoaded;                          ///< Flag indicating if the model is loaded
+    QString modelSource;                       ///< File or resource path the model was loaded from
+    torch::ScalarType modelDtype;              ///< Parameter dtype the model was loaded with
 };
 
 #endif // HTSATPROCESSOR_H
@@ -1,123 +1,431 @@
 #include "htsatworker.h"
 #include "resourcemanager.h"
 #include "audio_preprocess_utils.h"
+#include "threadbudget.h"
+#include "modelregistry.h"
+#include "boundedqueue.h"
+#include "embeddingcache.h"
 #include <QDebug>
+#include <QFileInfo>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <vector>
 #include "constants.h"
-#include <sndfile.h>
+#include <torch/torch.h>
 
 HTSATWorker::HTSATWorker(QObject *parent)
     : QObject(parent)
 {
 }
 
-void HTSATWorker::generateFeatures(const QStringList& filePaths, const QString& outputFileName) {
-    std::vector<float> avg_emb = doGenerateAudioFeatures(filePaths, outputFileName);
-    if (!avg_emb.empty()) {
-        emit finished(avg_emb, outputFileName);
+JobControl* HTSATWorker::jobControl()
+{
+    return &control;
+}
+
+void HTSATWorker::generateFeatures(const QStringList& filePaths, const QString& outputFileName,
+                                   const EmbeddingOptions& options) {
+    // The processor goes out of scope before this returns; its model is then
+    // left in ModelRegistry or freed by releaseModelAfterJob()
+    FeatureRecord record;
+    {
+        ThreadBudget::JobLease lease("feature extraction");
+        record = doGenerateAudioFeatures(filePaths, options);
+    }
+    releaseModelAfterJob();
+    if (control.isStopped()) {
+        emit stopped();
+    } else if (!record.members.empty()) {
+        emit finished(record, outputFileName);
     } else {
         emit error("Failed to generate features");
     }
 }
 
-std::vector<float> HTSATWorker::doGenerateAudioFeatures(const QStringList& filePaths, const QString& outputFileName)
+void HTSATWorker::updateFeature(const QString& featurePath, const QStringList& filePaths)
 {
+    FeatureRecord record;
+    int embeddedFiles = 0;
+    QString errorMessage;
+    bool ok = false;
+    {
+        ThreadBudget::JobLease lease("feature update");
+        ok = doUpdateFeature(featurePath, filePaths, record, embeddedFiles, errorMessage);
+    }
+    releaseModelAfterJob();
+    if (control.isStopped()) {
+        emit stopped();
+    } else if (ok) {
+        emit featureUpdated(record, featurePath, embeddedFiles);
+    } else {
+        emit error(errorMessage);
+    }
+}
+
+void HTSATWorker::warmUp()
+{
+    ThreadBudget::JobLease lease("HTSAT warm-up");
+    // The module stays in ModelRegistry after the processor goes away
     HTSATProcessor processor;
+    bool ok = loadModel(processor);
+    if (ok) {
+        ok = processor.processBatch(torch::zeros({1, Constants::AUDIO_CLIP_SAMPLES})).defined();
+    }
+    qDebug() << "HTSATWorker: warm-up" << (ok ? "finished" : "failed");
+    emit warmedUp(ok);
+}
+
+bool HTSATWorker::loadModel(HTSATProcessor& processor)
+{
     if (!processor.loadModelFromResource(Constants::HTSAT_MODEL_RESOURCE)) {
         qDebug() << "Failed to load HTSAT model from resource, trying absolute path...";
         if (!processor.loadModel(Constants::HTSAT_MODEL_PATH)) {
             qDebug() << "Failed to load HTSAT model";
-            return std::vector<float>();
+            return false;
         }
     }
+    modelKey = processor.registryKey();
+    return true;
+}
 
-    QVector<std::vector<float>> embeddings = processFilesAndCollectEmbeddings(filePaths, &processor);
-    if (embeddings.isEmpty()) {
-        return std::vector<float>();
+/**
+ * @brief Frees the HTSAT model after a job unless another worker still holds it.
+ *
+ * Without a model memory budget a finished job frees it, as jobs did before
+ * ModelRegistry; with a budget it stays warm until LRU eviction. A cancelled
+ * job always gives the memory back, and a preempted one keeps the model for
+ * the job that displaced it.
+ */
+void HTSATWorker::releaseModelAfterJob()
+{
+    const JobControl::StopReason stopReason = control.stopReason();
+    const bool keep = stopReason == JobControl::StopReason::None
+        ? ModelRegistry::instance().budgetBytes() > 0
+        : stopReason != JobControl::StopReason::Cancelled;
+    if (!keep && !modelKey.isEmpty() && ModelRegistry::instance().releaseIfIdle(modelKey)) {
+        qDebug() << "HTSATWorker: HTSAT model released";
+        emit modelReleased();
     }
-
-    std::vector<float> avg_emb = computeAverageEmbedding(embeddings);
-    return avg_emb;
 }
 
+FeatureRecord HTSATWorker::doGenerateAudioFeatures(const QStringList& filePaths, const EmbeddingOptions& options)
+{
+    FeatureRecord record;
+    HTSATProcessor processor;
+    if (!loadModel(processor)) {
+        return record;
+    }
 
+    record.modelVersion = processor.modelVersion();
+    record.options = options;
+    record.members = processFilesAndCollectEmbeddings(filePaths, &processor, options);
+    return record;
+}
 
-QVector<std::vector<float>> HTSATWorker::processFilesAndCollectEmbeddings(const QStringList& filePaths, HTSATProcessor* processor)
+/**
+ * @brief Adds files to a saved feature, embedding only those it does not already hold.
+ *
+ * A listed file that is already a member is embedded again only if its content
+ * changed; the feature's own EmbeddingOptions are used so old and new members
+ * stay comparable.
+ */
+bool HTSATWorker::doUpdateFeature(const QString& featurePath, const QStringList& filePaths, FeatureRecord& record,
+                                  int& embeddedFiles, QString& errorMessage)
 {
-    QVector<std::vector<float>> embeddings;
-    int totalFiles = filePaths.size();
-    for (int i = 0; i < totalFiles; ++i) {
-        const QString& filePath = filePaths[i];
+    if (!FeatureStore::loadMembers(featurePath, &record, &errorMessage)) {
+        errorMessage += " - create the feature again to make it updatable";
+        return false;
+    }
 
-        // Get sample rate and channels
-        SF_INFO sfinfo;
-        SNDFILE* file = sf_open(filePath.toStdString().c_str(), SFM_READ, &sfinfo);
-        if (!file) {
-            qDebug() << "Failed to open file for info:" << filePath;
-            continue;
+    HTSATProcessor processor;
+    if (!loadModel(processor)) {
+        errorMessage = "Failed to load HTSAT model";
+        return false;
+    }
+    if (processor.modelVersion() != record.modelVersion) {
+        errorMessage = QString("%1 was built with a different embedding model; create it again")
+                           .arg(QFileInfo(featurePath).completeBaseName());
+        return false;
+    }
+
+    QStringList delta;
+    for (const QString& filePath : filePaths) {
+        const int index = record.indexOf(filePath);
+        if (index < 0 || record.members[index].contentHash != EmbeddingCache::instance().contentHash(filePath)) {
+            delta.append(filePath);
         }
-        int sampleRate = sfinfo.samplerate;
-        int channels = sfinfo.channels;
-        sf_close(file);
-
-        // Load audio tensor
-        qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Loading audio file:" << filePath;
-        torch::Tensor audioTensor = AudioPreprocessUtils::loadAudio(filePath);
-        if (audioTensor.numel() == 0) {
-            qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Failed to load audio:" << filePath;
-            continue;
+    }
+    qDebug() << "HTSATWorker::updateFeature -" << delta.size() << "of" << filePaths.size() << "files need embedding";
+
+    std::vector<FeatureMember> added = processFilesAndCollectEmbeddings(delta, &processor, record.options);
+    if (control.isStopped()) {
+        return false;
+    }
+    for (FeatureMember& member : added) {
+        const int index = record.indexOf(member.filePath);
+        if (index >= 0) {
+            record.members[index] = std::move(member);
+        } else {
+            record.members.push_back(std::move(member));
         }
+    }
+    embeddedFiles = static_cast<int>(added.size());
+    return true;
+}
+
+std::vector<FeatureMember> HTSATWorker::processFilesAndCollectEmbeddings(const QStringList& filePaths, HTSATProcessor* processor,
+                                                                         const EmbeddingOptions& options)
+{
+    const int totalFiles = filePaths.size();
+    if (totalFiles == 0) {
+        return std::vector<FeatureMember>();
+    }
 
-        qDebug() << "Audio tensor length:" << audioTensor.size(0);
-        qDebug() << "Audio tensor dtype:"
-                 << QString::fromStdString(std::string(audioTensor.dtype().name()));
-
-        // Process tensor
-        qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Processing tensor for file:" << filePath;
-// 確保 processor 接收 shape=(frames, 1)
-        torch::Tensor inputTensor = audioTensor.unsqueeze(1);
-        std::vector<float> embedding = processor->processTensor(inputTensor);
-        if (embedding.empty()) {
-            qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Failed to process tensor for file:" << filePath;
-        qDebug() << "Audio tensor length:" << audioTensor.size(0);
-        qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Audio tensor dtype:"
-                     << QString::fromStdString(std::string(audioTensor.dtype().name()));
-        qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Audio tensor numel:" << audioTensor.numel();
-
-            // Try to provide more specific error information
-            if (audioTensor.numel() == 0) {
-                qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Audio tensor is empty";
-            } else {
-                auto minVal = audioTensor.min().item<float>();
-                auto maxVal = audioTensor.max().item<float>();
-                qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Audio value range: [" << minVal << "," << maxVal << "]";
-
-                if (!torch::isfinite(audioTensor).all().item<bool>()) {
-                    qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Audio tensor contains NaN or infinite values";
+    // Stage 1: decoder threads load, resample and cut files into windows, in any order.
+    // A full-length file can hold up to maxWindowsPerFile clips, so fewer of them are buffered
+    const int batchSize = Constants::EMBEDDING_BATCH_SIZE;
+    BoundedQueue<DecodedFile> decodeQueue(options.coverage == EmbeddingCoverage::FullLength
+                                              ? Constants::PIPELINE_QUEUE_DEPTH : batchSize * 2);
+    std::atomic<int> nextFile{0};
+    const int numDecoders = std::min(totalFiles, std::max(ThreadBudget::instance().dspThreads(),
+                                                          Constants::EMBEDDING_DECODE_THREADS));
+    std::atomic<int> activeDecoders{numDecoders};
+    // Files already embedded with this model and these settings are served from the cache.
+    // Content hashes are kept either way: they identify the members of a saved feature
+    const QString modelVersion = processor->modelVersion();
+    const QString preprocessing = preprocessingTag(options);
+    std::vector<QString> hashes(totalFiles);
+    std::vector<std::thread> decoders;
+    for (int d = 0; d < numDecoders; ++d) {
+        decoders.emplace_back([&, totalFiles]() {
+            ThreadBudget::enterDspThread();
+            EmbeddingCache& cache = EmbeddingCache::instance();
+            for (int index = nextFile++; index < totalFiles; index = nextFile++) {
+                QString cacheKey;
+                hashes[index] = cache.contentHash(filePaths[index]);
+                if (options.useCache && !hashes[index].isEmpty()) {
+                    cacheKey = EmbeddingCache::keyFor(hashes[index], modelVersion, preprocessing);
                 }
+                DecodedFile decoded;
+                if (cacheKey.isEmpty() || !cache.lookup(cacheKey, decoded.cached)) {
+                    decoded = decodeFile(filePaths[index], options);
+                    decoded.cacheKey = cacheKey;
+                }
+                decoded.index = index;
+                if (!decodeQueue.push(std::move(decoded))) {
+                    break;
+                }
+            }
+            // The last decoder to finish ends the stream
+            if (--activeDecoders == 0) {
+                decodeQueue.close();
             }
+        });
+    }
 
-            // Continue processing other files instead of failing completely
-            qDebug() << "HTSATWorker::processFilesAndCollectEmbeddings - Skipping file and continuing with other files";
+    // Stage 2: gather at least batchSize windows, then embed them batchSize rows per forward call
+    std::vector<std::vector<float>> byFile(totalFiles);
+    std::vector<DecodedFile> batch;
+    int64_t batchWindows = 0;
+    int doneFiles = 0;
+    int cacheHits = 0;
+    int cacheMisses = 0;
+    bool stopped = false;
+    auto flush = [&]() {
+        if (!batch.empty()) {
+            embedBatch(batch, processor, byFile);
+            doneFiles += static_cast<int>(batch.size());
+            batch.clear();
+            batchWindows = 0;
+            emit progressUpdated(doneFiles * 100 / totalFiles);
+        }
+    };
+
+    DecodedFile decoded;
+    while (decodeQueue.pop(decoded)) {
+        if (!decoded.cached.empty()) {
+            byFile[decoded.index] = std::move(decoded.cached);
+            ++cacheHits;
+            emit progressUpdated(++doneFiles * 100 / totalFiles);
+            decoded = DecodedFile();
+            continue;
+        }
+        if (!decoded.windows.defined()) {
+            // Unreadable or invalid file: skip it and continue with the others
+            ++doneFiles;
             continue;
         }
-        embeddings.append(embedding);
-        int progress = (i + 1) * 100 / totalFiles;
-        emit progressUpdated(progress);
+        if (!decoded.cacheKey.isEmpty()) {
+            ++cacheMisses;
+        }
+        batchWindows += decoded.windows.size(0);
+        batch.push_back(std::move(decoded));
+        decoded = DecodedFile();
+        if (batchWindows >= batchSize) {
+            if (!control.checkpoint()) {
+                stopped = true;
+                break;
+            }
+            flush();
+        }
+    }
+    if (!stopped && !control.checkpoint()) {
+        stopped = true;
+    }
+    if (!stopped) {
+        flush();
+    }
+
+    decodeQueue.close();
+    for (std::thread& decoder : decoders) {
+        decoder.join();
+    }
+    if (stopped) {
+        return std::vector<FeatureMember>();
     }
-    return embeddings;
+    if (options.useCache) {
+        qDebug() << "HTSATWorker: embedding cache" << cacheHits << "hits," << cacheMisses << "misses";
+        emit embeddingCacheUsed(cacheHits, cacheMisses);
+    }
+
+    // Keep input order so the mean is independent of decode timing
+    std::vector<FeatureMember> members;
+    for (int i = 0; i < totalFiles; ++i) {
+        if (!byFile[i].empty()) {
+            FeatureMember member;
+            member.filePath = QFileInfo(filePaths[i]).absoluteFilePath();
+            member.contentHash = hashes[i];
+            member.embedding = std::move(byFile[i]);
+            members.push_back(std::move(member));
+        }
+    }
+    return members;
 }
 
-std::vector<float> HTSATWorker::computeAverageEmbedding(const QVector<std::vector<float>>& embeddings)
+/**
+ * @brief Settings that change a file's embedding besides the audio and the model, for cache keys.
+ */
+QString HTSATWorker::preprocessingTag(const EmbeddingOptions& options)
 {
-    std::vector<float> avg_emb(embeddings[0].size(), 0.0f);
-    for (const auto& emb : embeddings) {
-        for (size_t i = 0; i < emb.size(); ++i) {
-            avg_emb[i] += emb[i];
+    QString tag = QString("sr%1_clip%2").arg(Constants::AUDIO_SAMPLE_RATE).arg(Constants::AUDIO_CLIP_SAMPLES);
+    if (options.coverage == EmbeddingCoverage::FullLength) {
+        tag += QString("_full_overlap%1_max%2_%3")
+                   .arg(options.windowOverlap).arg(options.maxWindowsPerFile)
+                   .arg(options.pooling == WindowPooling::EnergyWeighted ? "energy" : "mean");
+    }
+    return tag;
+}
+
+/**
+ * @brief Loads a reference file and cuts it into HTSAT windows of exactly AUDIO_CLIP_SAMPLES samples.
+ *
+ * FirstClip keeps one window (the first 10 s, zero-padded if shorter). FullLength
+ * tiles the whole file with the configured overlap, the last window zero-padded;
+ * past maxWindowsPerFile, windows are picked at uniformly spaced positions.
+ * @return Windows and pooling weights; windows are undefined if the file cannot be
+ *         read or contains NaN / infinite samples.
+ */
+HTSATWorker::DecodedFile HTSATWorker::decodeFile(const QString& filePath, const EmbeddingOptions& options)
+{
+    DecodedFile decoded;
+    // loadAudio opens the file once and handles channels and sample rate itself
+    torch::Tensor audio = AudioPreprocessUtils::loadAudio(filePath);
+    if (audio.numel() == 0) {
+        qDebug() << "HTSATWorker::decodeFile - Failed to load audio:" << filePath;
+        return decoded;
+    }
+    if (!torch::isfinite(audio).all().item<bool>()) {
+        qDebug() << "HTSATWorker::decodeFile - Audio contains NaN or infinite values, skipping:" << filePath;
+        return decoded;
+    }
+
+    const int64_t clipSamples = Constants::AUDIO_CLIP_SAMPLES;
+    const int64_t totalSamples = audio.size(0);
+    if (options.coverage == EmbeddingCoverage::FirstClip || totalSamples <= clipSamples) {
+        torch::Tensor clip = totalSamples >= clipSamples
+            ? audio.narrow(0, 0, clipSamples)
+            : torch::constant_pad_nd(audio, {0, clipSamples - totalSamples}, 0);
+        decoded.windows = clip.contiguous().view({1, clipSamples});
+        decoded.weights = torch::ones({1});
+        return decoded;
+    }
+
+    const float overlap = std::min(std::max(options.windowOverlap, 0.0f), 0.9f);
+    const int64_t hop = std::max<int64_t>(1, static_cast<int64_t>(clipSamples * (1.0f - overlap)));
+    const int64_t numWindows = (totalSamples - clipSamples + hop - 1) / hop + 1;
+    torch::Tensor padded = torch::constant_pad_nd(audio, {0, (numWindows - 1) * hop + clipSamples - totalSamples}, 0);
+    torch::Tensor windows = padded.unfold(0, clipSamples, hop); // (numWindows, clipSamples) view
+
+    const int64_t maxWindows = std::max(1, options.maxWindowsPerFile);
+    if (numWindows > maxWindows) {
+        // Uniformly spaced picks, always including the first and last window
+        torch::Tensor picks = torch::linspace(0, static_cast<double>(numWindows - 1), maxWindows)
+                                  .round().to(torch::kLong);
+        windows = windows.index_select(0, picks);
+    }
+    decoded.windows = windows.contiguous();
+
+    if (options.pooling == WindowPooling::EnergyWeighted) {
+        torch::Tensor rms = decoded.windows.pow(2).mean(1).sqrt();
+        const float total = rms.sum().item<float>();
+        decoded.weights = total > 0.0f ? rms / total : torch::full({decoded.windows.size(0)}, 1.0f / decoded.windows.size(0));
+    } else {
+        decoded.weights = torch::full({decoded.windows.size(0)}, 1.0f / decoded.windows.size(0));
+    }
+    return decoded;
+}
+
+/**
+ * @brief Embeds the windows of several files, EMBEDDING_BATCH_SIZE rows per forward call, and pools
+ *        each file's window embeddings into its slot of `byFile`.
+ *
+ * If a batched call fails, the files are retried one by one so a single bad
+ * input does not drop the rest of the batch.
+ */
+void HTSATWorker::embedBatch(const std::vector<DecodedFile>& batch, HTSATProcessor* processor,
+                             std::vector<std::vector<float>>& byFile)
+{
+    std::vector<torch::Tensor> parts;
+    parts.reserve(batch.size());
+    for (const DecodedFile& decoded : batch) {
+        parts.push_back(decoded.windows);
+    }
+    torch::Tensor windows = parts.size() == 1 ? parts.front() : torch::cat(parts, 0);
+
+    const int64_t batchSize = Constants::EMBEDDING_BATCH_SIZE;
+    std::vector<torch::Tensor> outputs;
+    for (int64_t start = 0; start < windows.size(0); start += batchSize) {
+        ThreadBudget::instance().applyJobShare();
+        torch::Tensor output = processor->processBatch(windows.slice(0, start, start + batchSize));
+        if (!output.defined()) {
+            outputs.clear();
+            break;
+        }
+        outputs.push_back(output);
+    }
+
+    if (outputs.empty()) {
+        if (batch.size() == 1) {
+            qDebug() << "HTSATWorker::embedBatch - Skipping file" << batch.front().index << "after inference failure";
+            return;
+        }
+        qDebug() << "HTSATWorker::embedBatch - Batched inference failed, retrying" << batch.size() << "files one by one";
+        for (const DecodedFile& decoded : batch) {
+            embedBatch({decoded}, processor, byFile);
         }
+        return;
     }
-    for (size_t i = 0; i < avg_emb.size(); ++i) {
-        avg_emb[i] /= embeddings.size();
+
+    torch::Tensor embeddings = torch::cat(outputs, 0);
+    int64_t row = 0;
+    for (const DecodedFile& decoded : batch) {
+        const int64_t count = decoded.windows.size(0);
+        torch::Tensor pooled = (embeddings.narrow(0, row, count) * decoded.weights.unsqueeze(1)).sum(0).contiguous();
+        byFile[decoded.index].assign(pooled.data_ptr<float>(), pooled.data_ptr<float>() + pooled.numel());
+        if (!decoded.cacheKey.isEmpty()) {
+            EmbeddingCache::instance().store(decoded.cacheKey, byFile[decoded.index]);
+        }
+        row += count;
     }
-    return avg_emb;
 }
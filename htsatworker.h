@@ -6,6 +6,8 @@
 #include <QVector>
 #include <vector>
 #include "htsatprocessor.h"
+#include "jobcontrol.h"
+#include "featurestore.h"
 
 class HTSATWorker : public QObject
 {
@@ -13,21 +15,57 @@ class HTSATWorker : public QObject
 
 public:
     explicit HTSATWorker(QObject *parent = nullptr);
+
+    // Cancel / pause / preempt flags, checked between files
+    JobControl* jobControl();
     
 
 public slots:
-    void generateFeatures(const QStringList& filePaths, const QString& outputFileName);
+    void generateFeatures(const QStringList& filePaths, const QString& outputFileName,
+                          const EmbeddingOptions& options = EmbeddingOptions());
+
+    // Embed only the files not yet in the feature (or changed since) and update its members in place
+    void updateFeature(const QString& featurePath, const QStringList& filePaths);
+
+    // Load the model and run one dummy forward so the first job skips both
+    void warmUp();
     
 
 signals:
     void progressUpdated(int value);
-    void finished(const std::vector<float>& avgEmb, const QString& outputFileName);
+    void finished(const FeatureRecord& record, const QString& outputFileName);
+    void featureUpdated(const FeatureRecord& record, const QString& featurePath, int embeddedFiles);
     void error(const QString& errorMessage);
+    void stopped(); // Cancelled or preempted; see jobControl()->stopReason()
+    void embeddingCacheUsed(int hits, int misses); // Emitted before finished() when the cache was consulted
+    void warmedUp(bool ok);
+    void modelReleased(); // The HTSAT model was freed after a job; the next one reloads it
 
 private:
-    std::vector<float> doGenerateAudioFeatures(const QStringList& filePaths, const QString& outputFileName);
-    QVector<std::vector<float>> processFilesAndCollectEmbeddings(const QStringList& filePaths, HTSATProcessor* processor);
-    std::vector<float> computeAverageEmbedding(const QVector<std::vector<float>>& embeddings);
+    bool loadModel(HTSATProcessor& processor);
+    void releaseModelAfterJob();
+    FeatureRecord doGenerateAudioFeatures(const QStringList& filePaths, const EmbeddingOptions& options);
+    bool doUpdateFeature(const QString& featurePath, const QStringList& filePaths, FeatureRecord& record,
+                         int& embeddedFiles, QString& errorMessage);
+    // Decodes files on parallel threads and embeds their windows EMBEDDING_BATCH_SIZE at a time.
+    // Returns one member per file that could be embedded, in input order
+    std::vector<FeatureMember> processFilesAndCollectEmbeddings(const QStringList& filePaths, HTSATProcessor* processor,
+                                                                const EmbeddingOptions& options = EmbeddingOptions());
+
+    struct DecodedFile {
+        int index = -1;         // Position in filePaths
+        torch::Tensor windows;  // (W, AUDIO_CLIP_SAMPLES); undefined if the file could not be used
+        torch::Tensor weights;  // (W), sums to 1
+        QString cacheKey;       // EmbeddingCache key; empty if the file is not cached
+        std::vector<float> cached; // Embedding found in the cache; nothing was decoded
+    };
+    static DecodedFile decodeFile(const QString& filePath, const EmbeddingOptions& options);
+    static QString preprocessingTag(const EmbeddingOptions& options);
+    void embedBatch(const std::vector<DecodedFile>& batch, HTSATProcessor* processor,
+                    std::vector<std::vector<float>>& byFile);
+
+    JobControl control;
+    QString modelKey; // ModelRegistry key of the HTSAT model this worker last loaded
 };
 
 #endif // HTSATWORKER_H
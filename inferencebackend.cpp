@@ -0,0 +1,153 @@
+#include "inferencebackend.h"
+#include "constants.h"
+#include "modelloader.h"
+#include "modelregistry.h"
+#include "referencebackend.h"
+#include "torchscriptbackend.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <mutex>
+
+torch::Tensor SeparationBackend::separateMany(const torch::Tensor& waveform, const torch::Tensor& conditions)
+{
+    const int64_t numWindows = waveform.size(0);
+    const int64_t numFeatures = conditions.size(0);
+    // Row w * F + f holds window w conditioned on feature f
+    torch::Tensor output = separate(waveform.repeat_interleave(numFeatures, 0), conditions.repeat({numWindows, 1}));
+    return output.view({numWindows, numFeatures, output.size(1), output.size(2)});
+}
+
+namespace InferenceBackends {
+
+namespace {
+
+std::mutex s_mutex;
+Kind s_kind = Kind::TorchScript;
+ReferenceCost s_cost = {Constants::DEFAULT_REFERENCE_EMBED_MS, Constants::DEFAULT_REFERENCE_SEPARATE_MS};
+
+/**
+ * @brief Loads a TorchScript module through ModelRegistry; ":/..." sources are Qt resources.
+ */
+ModelRegistry::Handle acquireModule(const QString& source, torch::ScalarType dtype, QString* errorMessage)
+{
+    const bool fromResource = source.startsWith(":/");
+    if (!fromResource && !QFileInfo::exists(source)) {
+        if (errorMessage) *errorMessage = "Model file does not exist: " + source;
+        return nullptr;
+    }
+    return ModelRegistry::instance().acquire(ModelRegistry::keyFor(source, dtype),
+        [&](torch::jit::script::Module& module, QString* message) {
+            return fromResource ? ModelLoader::loadFromResource(source, module, message, dtype)
+                                : ModelLoader::loadFromFile(source, module, message, dtype);
+        }, errorMessage);
+}
+
+void readCostEnv(const char* name, double& value)
+{
+    bool ok = false;
+    const double parsed = qEnvironmentVariable(name).toDouble(&ok);
+    if (ok && parsed >= 0.0) {
+        value = parsed;
+    }
+}
+
+} // namespace
+
+Kind kind()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_kind;
+}
+
+void setKind(Kind kind)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_kind = kind;
+}
+
+ReferenceCost referenceCost()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_cost;
+}
+
+void setReferenceCost(const ReferenceCost& cost)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_cost = cost;
+}
+
+bool parseKind(const QString& name, Kind* kind)
+{
+    const QString normalized = name.trimmed().toLower();
+    if (normalized == "torchscript") {
+        *kind = Kind::TorchScript;
+        return true;
+    }
+    if (normalized == "reference") {
+        *kind = Kind::Reference;
+        return true;
+    }
+    return false;
+}
+
+QString kindName(Kind kind)
+{
+    return kind == Kind::Reference ? "reference" : "torchscript";
+}
+
+void configureFromEnvironment()
+{
+    if (qEnvironmentVariableIsSet(Constants::ENV_INFERENCE_BACKEND)) {
+        Kind parsed = Kind::TorchScript;
+        if (parseKind(qEnvironmentVariable(Constants::ENV_INFERENCE_BACKEND), &parsed)) {
+            setKind(parsed);
+        } else {
+            qDebug() << "InferenceBackends: unknown" << Constants::ENV_INFERENCE_BACKEND
+                     << qEnvironmentVariable(Constants::ENV_INFERENCE_BACKEND) << "- using torchscript";
+        }
+    }
+
+    ReferenceCost cost = referenceCost();
+    readCostEnv(Constants::ENV_REFERENCE_EMBED_MS, cost.embedMsPerClip);
+    readCostEnv(Constants::ENV_REFERENCE_SEPARATE_MS, cost.separateMsPerChunk);
+    setReferenceCost(cost);
+}
+
+QString describe()
+{
+    if (kind() != Kind::Reference) {
+        return "Inference backend: torchscript";
+    }
+    const ReferenceCost cost = referenceCost();
+    return QString("Inference backend: reference (simulated %1 ms/clip embedding, %2 ms/chunk separation)")
+        .arg(cost.embedMsPerClip).arg(cost.separateMsPerChunk);
+}
+
+std::shared_ptr<EmbeddingBackend> openEmbedding(const QString& source, torch::ScalarType dtype,
+                                                QString* errorMessage)
+{
+    if (kind() == Kind::Reference) {
+        return std::make_shared<ReferenceEmbeddingBackend>(referenceCost().embedMsPerClip);
+    }
+    ModelRegistry::Handle model = acquireModule(source, dtype, errorMessage);
+    if (!model) {
+        return nullptr;
+    }
+    return std::make_shared<TorchScriptEmbeddingBackend>(std::move(model), dtype);
+}
+
+std::shared_ptr<SeparationBackend> openSeparation(const QString& source, torch::ScalarType dtype,
+                                                  QString* errorMessage)
+{
+    if (kind() == Kind::Reference) {
+        return std::make_shared<ReferenceSeparationBackend>(referenceCost().separateMsPerChunk);
+    }
+    ModelRegistry::Handle model = acquireModule(source, dtype, errorMessage);
+    if (!model) {
+        return nullptr;
+    }
+    return std::make_shared<TorchScriptSeparationBackend>(std::move(model), dtype);
+}
+
+} // namespace InferenceBackends
@@ -0,0 +1,136 @@
+#ifndef INFERENCEBACKEND_H
+#define INFERENCEBACKEND_H
+
+#include <QString>
+#include <memory>
+
+#ifndef Q_MOC_RUN
+#undef slots
+#include <torch/script.h>
+#define slots
+#endif
+
+/**
+ * @brief Computes query embeddings (the HTSAT side of the app).
+ *
+ * Implementations throw c10::Error or std::exception on failure; the
+ * processors turn that into their error signals.
+ */
+class EmbeddingBackend
+{
+public:
+    virtual ~EmbeddingBackend() = default;
+
+    /**
+     * @brief Embeds a batch of clips.
+     * @param clips Float32 tensor of shape (B, AUDIO_CLIP_SAMPLES), mono 32kHz.
+     * @return Float32 embeddings of shape (B, EMBEDDING_DIM).
+     */
+    virtual torch::Tensor embed(const torch::Tensor& clips) = 0;
+
+    virtual QString name() const = 0;
+};
+
+/**
+ * @brief Separates audio chunks conditioned on query embeddings (the ZeroShotASP side).
+ */
+class SeparationBackend
+{
+public:
+    virtual ~SeparationBackend() = default;
+
+    /**
+     * @brief Separates each chunk with its own condition.
+     * @param waveform Float32 tensor of shape (N, AUDIO_CLIP_SAMPLES, 1).
+     * @param condition Float32 tensor of shape (N, EMBEDDING_DIM).
+     * @return Float32 tensor of shape (N, AUDIO_CLIP_SAMPLES, 1).
+     */
+    virtual torch::Tensor separate(const torch::Tensor& waveform, const torch::Tensor& condition) = 0;
+
+    /**
+     * @brief Separates W chunks for each of F queries.
+     *
+     * The default repeats every chunk F times and calls separate(); backends
+     * that can reuse the mixture side across queries override it.
+     * @param waveform Float32 tensor of shape (W, AUDIO_CLIP_SAMPLES, 1).
+     * @param conditions Float32 tensor of shape (F, EMBEDDING_DIM).
+     * @return Float32 tensor of shape (W, F, AUDIO_CLIP_SAMPLES, 1).
+     */
+    virtual torch::Tensor separateMany(const torch::Tensor& waveform, const torch::Tensor& conditions);
+
+    /**
+     * @brief True when separateMany() computes the mixture side once per chunk.
+     */
+    virtual bool sharesMixtureEncoding() const { return false; }
+
+    virtual QString name() const = 0;
+};
+
+/**
+ * @brief Selects the backend the processors create and opens models through it.
+ *
+ * "torchscript" (the default) loads the .pt models through ModelRegistry.
+ * "reference" never touches a model file: it returns deterministic outputs of
+ * the right shapes after a configurable simulated cost, so scheduling,
+ * batching and I/O work can be measured by hand on machines without the
+ * models. Its outputs are not an approximation of the TorchScript models and
+ * are not checked against them; it is a timing stand-in, not a test oracle.
+ *
+ * Configured from AST_INFERENCE_BACKEND, AST_REFERENCE_EMBED_MS and
+ * AST_REFERENCE_SEPARATE_MS, or --backend, --reference-embed-ms and
+ * --reference-separate-ms, which take precedence. Set it before the first
+ * model is loaded; processors keep the backend they opened.
+ */
+namespace InferenceBackends {
+
+enum class Kind {
+    TorchScript,
+    Reference
+};
+
+struct ReferenceCost {
+    double embedMsPerClip = 0.0;     ///< Single-core milliseconds per embedded clip
+    double separateMsPerChunk = 0.0; ///< Single-core milliseconds per chunk and query
+};
+
+Kind kind();
+void setKind(Kind kind);
+ReferenceCost referenceCost();
+void setReferenceCost(const ReferenceCost& cost);
+
+/**
+ * @brief Parses "torchscript" or "reference" (case-insensitive).
+ * @return False if the name is unknown; `kind` is left unchanged.
+ */
+bool parseKind(const QString& name, Kind* kind);
+QString kindName(Kind kind);
+
+/**
+ * @brief Applies the AST_* environment variables on top of the defaults.
+ */
+void configureFromEnvironment();
+
+/**
+ * @brief One line describing the active backend, for logs and the status bar.
+ */
+QString describe();
+
+/**
+ * @brief Opens the embedding model from a file or Qt resource with the current backend.
+ * @param source Model file path or ":/..." resource path; ignored by the reference backend.
+ * @param dtype Parameter dtype for the TorchScript backend.
+ * @param errorMessage Receives the reason on failure (optional).
+ * @return The backend, or nullptr if the model could not be loaded.
+ */
+std::shared_ptr<EmbeddingBackend> openEmbedding(const QString& source, torch::ScalarType dtype,
+                                                QString* errorMessage = nullptr);
+
+/**
+ * @brief Opens the separation model; same conventions as openEmbedding().
+ */
+std::shared_ptr<SeparationBackend> openSeparation(const QString& source, torch::ScalarType dtype,
+                                                  QString* errorMessage = nullptr);
+
+} // namespace InferenceBackends
+
+#endif // INFERENCEBACKEND_H
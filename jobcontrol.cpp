@@ -0,0 +1,65 @@
+#include "jobcontrol.h"
+
+void JobControl::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopReason = static_cast<int>(StopReason::None);
+    m_paused = false;
+}
+
+void JobControl::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopReason = static_cast<int>(StopReason::Cancelled);
+    m_wake.notify_all();
+}
+
+void JobControl::preempt()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // A cancelled job stays cancelled
+    if (m_stopReason == static_cast<int>(StopReason::None)) {
+        m_stopReason = static_cast<int>(StopReason::Preempted);
+    }
+    m_wake.notify_all();
+}
+
+void JobControl::pause()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paused = true;
+}
+
+void JobControl::resume()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paused = false;
+    m_wake.notify_all();
+}
+
+bool JobControl::checkpoint()
+{
+    if (!isPaused()) {
+        return !isStopped();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait(lock, [this] { return !m_paused || isStopped(); });
+    return !isStopped();
+}
+
+bool JobControl::isStopped() const
+{
+    return m_stopReason != static_cast<int>(StopReason::None);
+}
+
+bool JobControl::isPaused() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_paused;
+}
+
+JobControl::StopReason JobControl::stopReason() const
+{
+    return static_cast<StopReason>(m_stopReason.load());
+}
@@ -0,0 +1,69 @@
+#ifndef JOBCONTROL_H
+#define JOBCONTROL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * @brief Cooperative stop and pause flags shared between the GUI thread and a worker.
+ *
+ * The GUI thread calls cancel(), preempt(), pause() and resume(); the worker
+ * calls checkpoint() at chunk or file boundaries. checkpoint() blocks while the
+ * job is paused and returns false once the job should stop.
+ */
+class JobControl
+{
+public:
+    /**
+     * @brief Why a job stopped before completing.
+     */
+    enum class StopReason {
+        None,      ///< Still running, or ran to completion
+        Cancelled, ///< Dropped by the user; its partial output is discarded
+        Preempted  ///< Yielded to a higher-priority job; unfinished files are re-queued
+    };
+
+    /**
+     * @brief Clears every flag before a new job starts.
+     */
+    void reset();
+
+    /**
+     * @brief Asks the job to stop and discard its work. Wakes a paused job.
+     */
+    void cancel();
+
+    /**
+     * @brief Asks the job to stop at the next boundary so another job can run. Wakes a paused job.
+     */
+    void preempt();
+
+    /**
+     * @brief Holds the job at its next checkpoint until resume() is called.
+     */
+    void pause();
+
+    /**
+     * @brief Releases a paused job.
+     */
+    void resume();
+
+    /**
+     * @brief Called by the worker between units of work.
+     * @return True to continue, false if the job has been cancelled or preempted.
+     */
+    bool checkpoint();
+
+    bool isStopped() const;
+    bool isPaused() const;
+    StopReason stopReason() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_stopReason{static_cast<int>(StopReason::None)};
+    bool m_paused = false;
+};
+
+#endif // JOBCONTROL_H
@@ -7,7 +7,99 @@
  */
 
 #include "mainwindow.h"
+#include "threadbudget.h"
+#include "modelregistry.h"
+#include "separationtiers.h"
+#include "inferencebackend.h"
+#include "featurestore.h"
+#include "constants.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QStatusBar>
+#include <QTimer>
+
+/**
+ * @brief Applies the thread and model-memory budgets and the inference backend from the environment,
+ *        overridden by command-line options, and the default separation tier.
+ * @param app The application whose arguments are parsed.
+ */
+static void configureFromCommandLine(const QApplication& app)
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption threadsOption("threads", "Cores the app may use (default: all).", "n");
+    QCommandLineOption interopOption("interop-threads", "libtorch inter-op threads.", "n");
+    QCommandLineOption dspOption("dsp-threads", "Cores reserved for decoding and writing audio.", "n");
+    QCommandLineOption memoryOption("model-memory-mb", "RAM for resident models; idle ones are evicted past it (0 = unlimited).", "mb");
+    QCommandLineOption tierOption("tier", QString("Default separation tier: %1.").arg(SeparationTiers::names().join(", ")), "name");
+    parser.addOption(threadsOption);
+    parser.addOption(interopOption);
+    parser.addOption(dspOption);
+    parser.addOption(memoryOption);
+    QCommandLineOption backendOption("backend", "Inference backend: torchscript or reference (no model files needed).", "name");
+    QCommandLineOption embedCostOption("reference-embed-ms", "Reference backend: simulated milliseconds per embedded clip.", "ms");
+    QCommandLineOption separateCostOption("reference-separate-ms", "Reference backend: simulated milliseconds per separated chunk.", "ms");
+    parser.addOption(tierOption);
+    parser.addOption(backendOption);
+    parser.addOption(embedCostOption);
+    parser.addOption(separateCostOption);
+    parser.process(app);
+
+    ThreadBudget::Config config = ThreadBudget::configFromEnvironment();
+    auto override = [&parser](const QCommandLineOption& option, int& value) {
+        bool ok = false;
+        const int parsed = parser.value(option).toInt(&ok);
+        if (parser.isSet(option) && ok && parsed > 0) {
+            value = parsed;
+        }
+    };
+    override(threadsOption, config.totalThreads);
+    override(interopOption, config.interopThreads);
+    override(dspOption, config.dspThreads);
+
+    ThreadBudget::instance().configure(config);
+    qDebug() << ThreadBudget::instance().describe();
+
+    bool ok = false;
+    const qint64 memoryMb = parser.value(memoryOption).toLongLong(&ok);
+    if (parser.isSet(memoryOption) && ok && memoryMb >= 0) {
+        ModelRegistry::instance().setBudgetBytes(memoryMb * 1024 * 1024);
+    }
+
+    InferenceBackends::configureFromEnvironment();
+    if (parser.isSet(backendOption)) {
+        InferenceBackends::Kind kind = InferenceBackends::kind();
+        if (InferenceBackends::parseKind(parser.value(backendOption), &kind)) {
+            InferenceBackends::setKind(kind);
+        } else {
+            qDebug() << "Unknown inference backend" << parser.value(backendOption) << "- using"
+                     << InferenceBackends::kindName(kind);
+        }
+    }
+    InferenceBackends::ReferenceCost cost = InferenceBackends::referenceCost();
+    auto overrideCost = [&parser](const QCommandLineOption& option, double& value) {
+        bool parsedOk = false;
+        const double parsed = parser.value(option).toDouble(&parsedOk);
+        if (parser.isSet(option) && parsedOk && parsed >= 0.0) {
+            value = parsed;
+        }
+    };
+    overrideCost(embedCostOption, cost.embedMsPerClip);
+    overrideCost(separateCostOption, cost.separateMsPerChunk);
+    InferenceBackends::setReferenceCost(cost);
+    qDebug() << InferenceBackends::describe();
+
+    if (parser.isSet(tierOption)) {
+        bool known = false;
+        const SeparationOptions tierOptions = SeparationTiers::options(parser.value(tierOption), &known);
+        if (known) {
+            ResourceManager::instance()->setDefaultSeparationTier(tierOptions.tier);
+        } else {
+            qDebug() << "Unknown separation tier" << parser.value(tierOption) << "- using" << SeparationTiers::STANDARD;
+        }
+    }
+}
 
 /**
  * @brief Main function.
@@ -18,7 +110,18 @@
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    // Before any model is loaded: libtorch's inter-op pool cannot be resized once started
+    configureFromCommandLine(a);
+    // Convert text features from older versions before the feature lists read the folder
+    FeatureStore::migrateTextFeatures(Constants::OUTPUT_FEATURES_DIR);
     MainWindow w;
+    QString status = ThreadBudget::instance().describe();
+    if (InferenceBackends::kind() == InferenceBackends::Kind::Reference) {
+        status += " | " + InferenceBackends::describe();
+    }
+    w.statusBar()->showMessage(status);
     w.show();
+    // Load and warm up both models in the background once the window is up
+    QTimer::singleShot(0, ResourceManager::instance(), &ResourceManager::warmUpModels);
     return a.exec();
 }
@@ -2,6 +2,7 @@
 #include "fileutils.h"
 #include "constants.h"
 #include <QMessageBox>
+#include <QStatusBar>
 #include <QTimer>
 
 /**
@@ -52,7 +53,34 @@ void MainWindow::setupUI()
     globalProgressBar->setTextVisible(false); // Hide percentage text initially
     globalProgressBar->setFixedHeight(Constants::PROGRESS_BAR_HEIGHT);
     globalProgressBar->setVisible(false);     // Hidden by default
-    mainVLayout->addWidget(globalProgressBar);
+
+    // Pause / cancel controls for the running job, shown with the progress bar
+    pauseButton = new QPushButton("Pause", this);
+    cancelButton = new QPushButton("Cancel", this);
+    pauseButton->setVisible(false);
+    cancelButton->setVisible(false);
+
+    QHBoxLayout* progressLayout = new QHBoxLayout();
+    progressLayout->addWidget(globalProgressBar, 1);
+    progressLayout->addWidget(pauseButton);
+    progressLayout->addWidget(cancelButton);
+    mainVLayout->addLayout(progressLayout);
+
+    connect(pauseButton, &QPushButton::clicked, this, []() {
+        ResourceManager* rm = ResourceManager::instance();
+        if (rm->isProcessingPaused()) {
+            rm->resumeProcessing();
+        } else {
+            rm->pauseProcessing();
+        }
+    });
+    connect(cancelButton, &QPushButton::clicked, this, []() {
+        ResourceManager::instance()->cancelProcessing();
+    });
+
+    modelStatusLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(modelStatusLabel);
+    onModelStateChanged();
 
     centralWidgetContainer->setLayout(mainVLayout);
     setCentralWidget(centralWidgetContainer);
@@ -141,6 +169,11 @@ void MainWindow::setupConnections()
     connect(rm, &ResourceManager::processingProgress, this, &MainWindow::updateProgress);
     connect(rm, &ResourceManager::processingFinished, this, &MainWindow::onProcessingFinished);
     connect(rm, &ResourceManager::processingError, this, &MainWindow::onProcessingError);
+    connect(rm, &ResourceManager::processingFinishedWithErrors, this, &MainWindow::onProcessingFinishedWithErrors);
+    connect(rm, &ResourceManager::processingReport, this, &MainWindow::onProcessingReport);
+    connect(rm, &ResourceManager::processingCancelled, this, &MainWindow::onProcessingCancelled);
+    connect(rm, &ResourceManager::processingPaused, this, &MainWindow::onProcessingPaused);
+    connect(rm, &ResourceManager::modelStateChanged, this, &MainWindow::onModelStateChanged);
 
     // Connect playRequested from AddSoundFeatureWidget
     connect(addSoundFeatureWidget, &AddSoundFeatureWidget::playRequested, this, &MainWindow::onPlayRequested);
@@ -264,6 +297,9 @@ void MainWindow::onProcessingStarted()
     globalProgressBar->setVisible(true);
     globalProgressBar->setTextVisible(true);
     globalProgressBar->setFormat("Processing... %p%");
+    pauseButton->setText("Pause");
+    pauseButton->setVisible(true);
+    cancelButton->setVisible(true);
 }
 
 
@@ -276,10 +312,7 @@ void MainWindow::onProcessingFinished(const QStringList& results)
     globalProgressBar->setValue(100);
     globalProgressBar->setFormat("Completed! %p%");
     // Hide progress bar after a short delay to show completion
-    QTimer::singleShot(2000, this, [this]() {
-        globalProgressBar->setVisible(false);
-        globalProgressBar->setTextVisible(false);
-    });
+    QTimer::singleShot(2000, this, &MainWindow::hideProgressIfIdle);
 }
 
 /**
@@ -291,9 +324,87 @@ void MainWindow::onProcessingError(const QString& error)
     globalProgressBar->setValue(100);
     globalProgressBar->setFormat("Error! %p%");
     // Hide progress bar after showing error briefly
-    QTimer::singleShot(3000, this, [this]() {
-        globalProgressBar->setVisible(false);
-        globalProgressBar->setTextVisible(false);
-    });
+    QTimer::singleShot(3000, this, &MainWindow::hideProgressIfIdle);
     QMessageBox::critical(this, "Processing Error", error);
 }
+
+/**
+ * @brief Slot to list the per-file errors of a job that otherwise completed.
+ * @param errors Error messages in the order they occurred.
+ */
+void MainWindow::onProcessingFinishedWithErrors(const QStringList& errors)
+{
+    globalProgressBar->setFormat(QString("Completed with %1 error(s) %p%").arg(errors.size()));
+    // One dialog per job; a long list is cut so the box stays on screen
+    const int shown = 10;
+    QString details = errors.mid(0, shown).join("\n");
+    if (errors.size() > shown) {
+        details += QString("\n... and %1 more").arg(errors.size() - shown);
+    }
+    QMessageBox::warning(this, "Processing Finished With Errors",
+                         QString("%1 error(s) occurred; the other files were processed:\n\n%2")
+                             .arg(errors.size()).arg(details));
+}
+
+/**
+ * @brief Slot to show an informational processing report.
+ * @param message Report text.
+ */
+void MainWindow::onProcessingReport(const QString& message)
+{
+    statusBar()->showMessage(message, 10000);
+}
+
+/**
+ * @brief Slot to handle a cancelled job.
+ */
+void MainWindow::onProcessingCancelled()
+{
+    globalProgressBar->setFormat("Cancelled");
+    statusBar()->showMessage("Processing cancelled", 5000);
+    QTimer::singleShot(2000, this, &MainWindow::hideProgressIfIdle);
+}
+
+/**
+ * @brief Slot to update the pause button when a job is paused or resumed.
+ * @param paused True if the running job is now paused.
+ */
+void MainWindow::onProcessingPaused(bool paused)
+{
+    pauseButton->setText(paused ? "Resume" : "Pause");
+    globalProgressBar->setFormat(paused ? "Paused %p%" : "Processing... %p%");
+}
+
+/**
+ * @brief Hides the progress controls unless another job has started.
+ */
+void MainWindow::hideProgressIfIdle()
+{
+    // Queued jobs start as soon as the previous one ends; keep the bar for them
+    if (ResourceManager::instance()->isProcessing()) {
+        return;
+    }
+    globalProgressBar->setVisible(false);
+    globalProgressBar->setTextVisible(false);
+    pauseButton->setVisible(false);
+    cancelButton->setVisible(false);
+}
+
+/**
+ * @brief Slot to show the models' load / warm-up state in the status bar.
+ */
+void MainWindow::onModelStateChanged()
+{
+    auto describe = [](ResourceManager::ModelState state) {
+        switch (state) {
+        case ResourceManager::ModelState::WarmingUp: return QString("warming up...");
+        case ResourceManager::ModelState::Ready: return QString("ready");
+        case ResourceManager::ModelState::Failed: return QString("failed to load");
+        default: return QString("not loaded");
+        }
+    };
+    ResourceManager* rm = ResourceManager::instance();
+    modelStatusLabel->setText(QString("HTSAT: %1 | Separation: %2")
+                              .arg(describe(rm->modelState(ResourceManager::ModelKind::Embedding)),
+                                   describe(rm->modelState(ResourceManager::ModelKind::Separation))));
+}
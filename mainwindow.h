@@ -9,6 +9,7 @@
 #include <QHBoxLayout>
 #include <QStackedWidget>
 #include <QProgressBar>
+#include <QLabel>
 
 #include "addsoundfeaturewidget.h"
 #include "usefeaturewidget.h"
@@ -41,6 +42,9 @@ private:
     QHBoxLayout* mainLayout;          ///< Main horizontal layout (sidebar + content)
     QStackedWidget* stackedContent;   ///< Stacked widget for different content pages
     QProgressBar* globalProgressBar;  ///< Global progress bar at the bottom
+    QPushButton* pauseButton;         ///< Pauses / resumes the running job
+    QPushButton* cancelButton;        ///< Cancels the running job
+    QLabel* modelStatusLabel;         ///< Permanent status-bar label with the models' warm-up state
     AddSoundFeatureWidget* addSoundFeatureWidget;
     UseFeatureWidget* useFeatureWidget;
     AudioPlayer* audioPlayer;         ///< Audio player widget for playback control
@@ -118,6 +122,39 @@ private slots:
      */
     void onProcessingError(const QString& error);
 
+    /**
+     * @brief Slot to list the per-file errors of a job that otherwise completed.
+     * @param errors Error messages in the order they occurred.
+     */
+    void onProcessingFinishedWithErrors(const QStringList& errors);
+
+    /**
+     * @brief Slot to show an informational processing report.
+     * @param message Report text.
+     */
+    void onProcessingReport(const QString& message);
+
+    /**
+     * @brief Slot to handle a cancelled job.
+     */
+    void onProcessingCancelled();
+
+    /**
+     * @brief Slot to update the pause button when a job is paused or resumed.
+     * @param paused True if the running job is now paused.
+     */
+    void onProcessingPaused(bool paused);
+
+    /**
+     * @brief Hides the progress controls unless another job has started.
+     */
+    void hideProgressIfIdle();
+
+    /**
+     * @brief Slot to show the models' load / warm-up state in the status bar.
+     */
+    void onModelStateChanged();
+
 };
 
 #endif // MAINWINDOW_H
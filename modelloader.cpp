@@ -0,0 +1,265 @@
+#include "modelloader.h"
+#include "constants.h"
+#include <torch/version.h>
+#include <torch/csrc/jit/runtime/graph_executor.h>
+#include <caffe2/serialize/read_adapter_interface.h>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QResource>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace ModelLoader {
+
+namespace {
+
+/**
+ * @brief Process-wide executor settings, applied before the first model is loaded.
+ */
+void configureRuntime()
+{
+    static std::once_flag once;
+    std::call_once(once, []() {
+        // Frozen graphs are already optimized; skip the profiling runs on the first forwards
+        torch::jit::getProfilingMode() = false;
+    });
+}
+
+// Bump when the optimization passes change what a cache entry contains
+const int CACHE_FORMAT_VERSION = 2;
+
+/**
+ * @brief Top-level methods other than forward (e.g. encode/decode); freezing would otherwise drop them.
+ */
+std::vector<std::string> extraMethods(const torch::jit::script::Module& module)
+{
+    std::vector<std::string> names;
+    for (const torch::jit::Method& method : module.get_methods()) {
+        if (method.name() != "forward") {
+            names.push_back(method.name());
+        }
+    }
+    return names;
+}
+
+QString cachePathFor(const QString& key, bool optimized)
+{
+    return QString("%1/%2%3.pt").arg(Constants::MODEL_CACHE_DIR, key, optimized ? "" : "_frozen");
+}
+
+/**
+ * @brief Lets torch::jit::load read an archive in place: a mapped file or resource data.
+ *
+ * The deserializer pulls records straight out of the buffer, so no stream or
+ * temporary copy of the whole archive is made. The buffer must outlive the load.
+ */
+class MemoryReadAdapter : public caffe2::serialize::ReadAdapterInterface
+{
+public:
+    MemoryReadAdapter(const char* data, size_t size)
+        : m_data(data), m_size(size)
+    {
+    }
+
+    size_t size() const override
+    {
+        return m_size;
+    }
+
+    size_t read(uint64_t pos, void* buf, size_t n, const char* /*what*/) const override
+    {
+        if (pos >= m_size) {
+            return 0;
+        }
+        const size_t count = std::min<size_t>(n, m_size - pos);
+        std::memcpy(buf, m_data + pos, count);
+        return count;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+};
+
+torch::jit::script::Module loadFromBytes(const QByteArray& data)
+{
+    return torch::jit::load(std::make_shared<MemoryReadAdapter>(data.constData(), static_cast<size_t>(data.size())));
+}
+
+// Largest archive a QByteArray view can describe on every supported Qt version
+const qint64 MAX_ARCHIVE_BYTES = std::numeric_limits<int>::max();
+
+/**
+ * @brief Memory-maps a file for the duration of fn(view); falls back to reading it.
+ *
+ * Only the load reads the mapping: torch::jit::load copies the weights into
+ * tensors, and the file is unmapped as soon as fn returns. Mapping saves the
+ * transient buffer holding the whole archive next to those tensors.
+ */
+template <typename Fn>
+bool withMappedFile(const QString& path, Fn fn, QString* errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) *errorMessage = QString("Model file does not exist or is not readable: %1").arg(path);
+        return false;
+    }
+    if (file.size() > MAX_ARCHIVE_BYTES) {
+        if (errorMessage) *errorMessage = QString("Model file is larger than 2 GB: %1").arg(path);
+        return false;
+    }
+
+    uchar* mapped = file.size() > 0 ? file.map(0, file.size()) : nullptr;
+    if (!mapped) {
+        qDebug() << "ModelLoader: could not map" << path << "- reading it instead";
+        return fn(file.readAll());
+    }
+    const bool result = fn(QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), static_cast<int>(file.size())));
+    file.unmap(mapped);
+    return result;
+}
+
+/**
+ * @brief Loads a cache entry; deserialization errors propagate as c10::Error.
+ */
+bool loadCached(const QString& cachePath, torch::jit::script::Module& module)
+{
+    return withMappedFile(cachePath, [&module](const QByteArray& view) {
+        module = loadFromBytes(view);
+        return true;
+    }, nullptr);
+}
+
+/**
+ * @brief Writes the module to the cache; a half-written file never replaces a good one.
+ */
+bool saveToCache(const torch::jit::script::Module& module, const QString& cachePath)
+{
+    QDir().mkpath(Constants::MODEL_CACHE_DIR);
+    const QString tempPath = cachePath + ".part";
+    try {
+        module.save(tempPath.toStdString());
+    } catch (const c10::Error& e) {
+        qDebug() << "ModelLoader: could not serialize module to" << cachePath << "-" << e.what();
+        QFile::remove(tempPath);
+        return false;
+    }
+    QFile::remove(cachePath);
+    return QFile::rename(tempPath, cachePath);
+}
+
+} // namespace
+
+QString cacheKey(const QByteArray& modelData, torch::ScalarType dtype)
+{
+    const QByteArray digest = QCryptographicHash::hash(modelData, QCryptographicHash::Sha256).toHex();
+    QString key = QString("%1_torch%2_v%3").arg(QString::fromLatin1(digest), QString(TORCH_VERSION))
+                      .arg(CACHE_FORMAT_VERSION);
+    if (dtype != torch::kFloat) {
+        key += QString("_%1").arg(QString(c10::toString(dtype)).toLower());
+    }
+    return key;
+}
+
+bool loadFromData(const QByteArray& modelData, torch::jit::script::Module& module, QString* errorMessage,
+                  torch::ScalarType dtype)
+{
+    if (modelData.isEmpty()) {
+        if (errorMessage) *errorMessage = "Model data is empty";
+        return false;
+    }
+
+    configureRuntime();
+
+    const QString key = cacheKey(modelData, dtype);
+    const QString optimizedPath = cachePathFor(key, true);
+    const QString frozenPath = cachePathFor(key, false);
+
+    // Cache hit: the optimized module loads as-is. Modules whose optimized form
+    // cannot be serialized are cached frozen and re-optimized, which is cheap.
+    try {
+        if (QFileInfo::exists(optimizedPath) && loadCached(optimizedPath, module)) {
+            module.eval();
+            qDebug() << "ModelLoader: loaded optimized module from cache" << optimizedPath;
+            return true;
+        }
+        if (QFileInfo::exists(frozenPath) && loadCached(frozenPath, module)) {
+            module.eval();
+            torch::jit::optimize_for_inference(module, extraMethods(module));
+            qDebug() << "ModelLoader: loaded frozen module from cache" << frozenPath;
+            return true;
+        }
+    } catch (const c10::Error& e) {
+        qDebug() << "ModelLoader: ignoring unreadable cache entry for" << key << "-" << e.what();
+        QFile::remove(optimizedPath);
+        QFile::remove(frozenPath);
+    }
+
+    torch::jit::script::Module loaded;
+    try {
+        loaded = loadFromBytes(modelData);
+        loaded.eval();
+        // Cast before freezing: frozen weights become graph constants that .to() no longer reaches
+        if (dtype != torch::kFloat) {
+            loaded.to(dtype);
+        }
+    } catch (const c10::Error& e) {
+        if (errorMessage) *errorMessage = QString::fromStdString(e.what());
+        return false;
+    }
+
+    // Freeze (inline parameters and submodules, fold constants), then apply the
+    // CPU inference passes. A model that cannot be frozen still runs in eval mode.
+    try {
+        const std::vector<std::string> methods = extraMethods(loaded);
+        torch::jit::script::Module frozen = torch::jit::freeze(loaded, methods);
+        torch::jit::script::Module optimized = frozen.clone();
+        torch::jit::optimize_for_inference(optimized, methods);
+
+        if (!saveToCache(optimized, optimizedPath)) {
+            saveToCache(frozen, frozenPath);
+        }
+        module = optimized;
+        qDebug() << "ModelLoader: froze and optimized module, cached as" << key;
+    } catch (const c10::Error& e) {
+        qDebug() << "ModelLoader: freeze/optimize failed, using the eval-mode module -" << e.what();
+        module = loaded;
+    }
+    return true;
+}
+
+bool loadFromFile(const QString& modelPath, torch::jit::script::Module& module, QString* errorMessage,
+                  torch::ScalarType dtype)
+{
+    return withMappedFile(modelPath, [&](const QByteArray& view) {
+        return loadFromData(view, module, errorMessage, dtype);
+    }, errorMessage);
+}
+
+bool loadFromResource(const QString& resourcePath, torch::jit::script::Module& module, QString* errorMessage,
+                      torch::ScalarType dtype)
+{
+    QResource resource(resourcePath);
+    if (!resource.isValid()) {
+        if (errorMessage) *errorMessage = QString("Invalid resource path: %1").arg(resourcePath);
+        return false;
+    }
+    // Uncompressed resources are read in place from the executable's mapped image
+    if (resource.compressionAlgorithm() == QResource::NoCompression) {
+        if (resource.size() > MAX_ARCHIVE_BYTES) {
+            if (errorMessage) *errorMessage = QString("Model resource is larger than 2 GB: %1").arg(resourcePath);
+            return false;
+        }
+        return loadFromData(QByteArray::fromRawData(reinterpret_cast<const char*>(resource.data()),
+                                                    static_cast<int>(resource.size())),
+                            module, errorMessage, dtype);
+    }
+    return loadFromData(resource.uncompressedData(), module, errorMessage, dtype);
+}
+
+} // namespace ModelLoader
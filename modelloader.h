@@ -0,0 +1,72 @@
+#ifndef MODELLOADER_H
+#define MODELLOADER_H
+
+#include <QByteArray>
+#include <QString>
+
+#ifndef Q_MOC_RUN
+#undef slots
+#include <torch/script.h>
+#define slots
+#endif
+
+/**
+ * @brief Namespace for loading TorchScript models ready for CPU inference.
+ *
+ * Models are frozen and passed through optimize_for_inference once; the result
+ * is serialized to Constants::MODEL_CACHE_DIR under a key made of the model's
+ * SHA-256 and the libtorch version, so later startups load the optimized module
+ * directly. The profiling executor is disabled, so the first forward calls do
+ * not pay for profiling runs. Top-level methods besides forward (such as the
+ * separation model's encode/decode) survive freezing and are optimized too.
+ *
+ * A reduced-precision dtype (e.g. torch::kBFloat16) casts the parameters before
+ * freezing, so the inlined weight constants are stored in that dtype; such
+ * variants are cached under their own key.
+ */
+namespace ModelLoader {
+
+/**
+ * @brief Loads and optimizes a model from a file, deserialized from a temporary mapping rather than a read buffer.
+ * @param modelPath Path to the TorchScript model file.
+ * @param module Receives the loaded module.
+ * @param errorMessage Receives a description on failure (optional).
+ * @param dtype Floating-point type of the parameters (default float32).
+ * @return True if loading succeeded.
+ */
+bool loadFromFile(const QString& modelPath, torch::jit::script::Module& module, QString* errorMessage = nullptr,
+                  torch::ScalarType dtype = torch::kFloat);
+
+/**
+ * @brief Loads and optimizes a model embedded as a Qt resource; uncompressed resources are read in place.
+ * @param resourcePath Resource path (e.g., ":/models/htsat_embedding_model.pt").
+ * @param module Receives the loaded module.
+ * @param errorMessage Receives a description on failure (optional).
+ * @param dtype Floating-point type of the parameters (default float32).
+ * @return True if loading succeeded.
+ */
+bool loadFromResource(const QString& resourcePath, torch::jit::script::Module& module, QString* errorMessage = nullptr,
+                      torch::ScalarType dtype = torch::kFloat);
+
+/**
+ * @brief Loads and optimizes a serialized model held in memory.
+ * @param modelData Serialized TorchScript archive, read in place (may be a QByteArray::fromRawData view).
+ * @param module Receives the loaded module.
+ * @param errorMessage Receives a description on failure (optional).
+ * @param dtype Floating-point type of the parameters (default float32).
+ * @return True if loading succeeded.
+ */
+bool loadFromData(const QByteArray& modelData, torch::jit::script::Module& module, QString* errorMessage = nullptr,
+                  torch::ScalarType dtype = torch::kFloat);
+
+/**
+ * @brief Cache key for a model: its SHA-256 followed by the libtorch version.
+ * @param modelData Serialized TorchScript archive.
+ * @param dtype Parameter dtype; anything but float32 adds a suffix.
+ * @return The key, usable as a file name.
+ */
+QString cacheKey(const QByteArray& modelData, torch::ScalarType dtype = torch::kFloat);
+
+} // namespace ModelLoader
+
+#endif // MODELLOADER_H
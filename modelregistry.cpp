@@ -0,0 +1,187 @@
+#include "modelregistry.h"
+#include "constants.h"
+#include <QDebug>
+#include <set>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/ir/constants.h>
+
+namespace {
+
+// Tensor constants inlined by torch::jit::freeze, counted once per storage
+void addGraphConstants(torch::jit::Block* block, std::set<const void*>& seen, qint64& bytes)
+{
+    for (torch::jit::Node* node : block->nodes()) {
+        if (node->kind() == c10::prim::Constant && node->output()->type()->cast<c10::TensorType>()) {
+            c10::optional<c10::IValue> value = torch::jit::toIValue(node->output());
+            if (value && value->isTensor()) {
+                const at::Tensor& tensor = value->toTensor();
+                if (tensor.has_storage() && seen.insert(tensor.storage().data()).second) {
+                    bytes += static_cast<qint64>(tensor.storage().nbytes());
+                }
+            }
+        }
+        for (torch::jit::Block* subBlock : node->blocks()) {
+            addGraphConstants(subBlock, seen, bytes);
+        }
+    }
+}
+
+} // namespace
+
+ModelRegistry& ModelRegistry::instance()
+{
+    static ModelRegistry registry;
+    return registry;
+}
+
+ModelRegistry::ModelRegistry()
+{
+    bool ok = false;
+    const qint64 megabytes = qEnvironmentVariableIntValue(Constants::ENV_MODEL_MEMORY_MB, &ok);
+    m_budgetBytes = (ok && megabytes > 0 ? megabytes : Constants::DEFAULT_MODEL_MEMORY_MB) * 1024 * 1024;
+}
+
+QString ModelRegistry::keyFor(const QString& source, torch::ScalarType dtype)
+{
+    return QString("%1@%2").arg(source, QString(c10::toString(dtype)));
+}
+
+qint64 ModelRegistry::footprintBytes(const torch::jit::script::Module& module)
+{
+    std::set<const void*> seen;
+    qint64 bytes = 0;
+    auto addTensor = [&](const at::Tensor& tensor) {
+        if (tensor.defined() && tensor.has_storage() && seen.insert(tensor.storage().data()).second) {
+            bytes += static_cast<qint64>(tensor.storage().nbytes());
+        }
+    };
+
+    for (const auto& parameter : module.named_parameters(/*recurse=*/true)) {
+        addTensor(parameter.value);
+    }
+    for (const auto& buffer : module.named_buffers(/*recurse=*/true)) {
+        addTensor(buffer.value);
+    }
+    for (const torch::jit::Method& method : module.get_methods()) {
+        addGraphConstants(method.graph()->block(), seen, bytes);
+    }
+    return bytes;
+}
+
+ModelRegistry::Handle ModelRegistry::acquire(const QString& key, const Loader& loader, QString* errorMessage)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            touch(it->second, key);
+            return it->second.module;
+        }
+    }
+
+    std::lock_guard<std::mutex> loadLock(m_loadMutex);
+    {
+        // Another thread may have loaded it while this one waited
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            touch(it->second, key);
+            return it->second.module;
+        }
+        // Make room up front when the model's size is known from an earlier load
+        auto known = m_knownBytes.find(key);
+        if (known != m_knownBytes.end()) {
+            evictIdleUntilFits(known->second, key);
+        }
+    }
+
+    auto module = std::make_shared<torch::jit::script::Module>();
+    if (!loader(*module, errorMessage)) {
+        return nullptr;
+    }
+    const qint64 bytes = footprintBytes(*module);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    evictIdleUntilFits(bytes, key);
+    Entry& entry = m_entries[key];
+    entry.module = module;
+    entry.bytes = bytes;
+    m_lru.push_front(key);
+    entry.lruPosition = m_lru.begin();
+    m_knownBytes[key] = bytes;
+    m_residentBytes += bytes;
+
+    qDebug() << "ModelRegistry: loaded" << key << "-" << bytes / (1024 * 1024) << "MB, resident"
+             << m_residentBytes / (1024 * 1024) << "MB of" << (m_budgetBytes > 0 ? m_budgetBytes / (1024 * 1024) : -1) << "MB";
+    if (m_budgetBytes > 0 && m_residentBytes > m_budgetBytes) {
+        qDebug() << "ModelRegistry: over budget; the remaining models are in use";
+    }
+    return module;
+}
+
+bool ModelRegistry::isResident(const QString& key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.count(key) > 0;
+}
+
+bool ModelRegistry::releaseIfIdle(const QString& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end() || it->second.module.use_count() > 1) {
+        return false;
+    }
+    qDebug() << "ModelRegistry: released" << key;
+    m_residentBytes -= it->second.bytes;
+    m_lru.erase(it->second.lruPosition);
+    m_entries.erase(it);
+    return true;
+}
+
+void ModelRegistry::setBudgetBytes(qint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budgetBytes = std::max<qint64>(0, bytes);
+    evictIdleUntilFits(0, QString());
+}
+
+qint64 ModelRegistry::budgetBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budgetBytes;
+}
+
+qint64 ModelRegistry::residentBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_residentBytes;
+}
+
+void ModelRegistry::touch(Entry& entry, const QString& key)
+{
+    m_lru.erase(entry.lruPosition);
+    m_lru.push_front(key);
+    entry.lruPosition = m_lru.begin();
+}
+
+void ModelRegistry::evictIdleUntilFits(qint64 incomingBytes, const QString& keep)
+{
+    if (m_budgetBytes <= 0) {
+        return;
+    }
+
+    // Walk from the least recently used end; held models are skipped, not freed
+    auto it = m_lru.end();
+    while (m_residentBytes + incomingBytes > m_budgetBytes && it != m_lru.begin()) {
+        --it;
+        auto entry = m_entries.find(*it);
+        if (*it == keep || entry == m_entries.end() || entry->second.module.use_count() > 1) {
+            continue;
+        }
+        qDebug() << "ModelRegistry: evicting" << *it << "to stay within the memory budget";
+        m_residentBytes -= entry->second.bytes;
+        m_entries.erase(entry);
+        it = m_lru.erase(it);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef MODELREGISTRY_H
+#define MODELREGISTRY_H
+
+#include <QString>
+#include <QtGlobal>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#ifndef Q_MOC_RUN
+#undef slots
+#include <torch/script.h>
+#define slots
+#endif
+
+/**
+ * @brief Process-wide cache of loaded TorchScript modules with a RAM budget.
+ *
+ * Processors ask for a module by key (model source plus precision) and get a
+ * shared handle; a model already resident for another worker is handed out
+ * again instead of being reloaded. Each entry's footprint is estimated from its
+ * parameters, buffers and inlined graph constants. When a load would take the
+ * total past the budget, least-recently-used models that no processor holds
+ * are dropped; models still in use are never freed underneath their users.
+ *
+ * The budget comes from AST_MODEL_MEMORY_MB or --model-memory-mb. With the
+ * default of 0 nothing is evicted, and workers free the models they own when a
+ * job ends (HTSATWorker) or is cancelled (both workers) through releaseIfIdle().
+ */
+class ModelRegistry
+{
+public:
+    using Handle = std::shared_ptr<torch::jit::script::Module>;
+    using Loader = std::function<bool(torch::jit::script::Module& module, QString* errorMessage)>;
+
+    static ModelRegistry& instance();
+
+    /**
+     * @brief Registry key for a model file or resource loaded with the given parameter dtype.
+     */
+    static QString keyFor(const QString& source, torch::ScalarType dtype = torch::kFloat);
+
+    /**
+     * @brief Returns the module for `key`, calling `loader` if it is not resident.
+     * @param key Identifies the model and its variant (e.g. ":/models/x.pt@bfloat16").
+     * @param loader Loads the module on a miss.
+     * @param errorMessage Receives the loader's error on failure (optional).
+     * @return A shared handle, or nullptr if loading failed.
+     */
+    Handle acquire(const QString& key, const Loader& loader, QString* errorMessage = nullptr);
+
+    /**
+     * @brief Whether the module for `key` is loaded, so acquiring it costs nothing.
+     */
+    bool isResident(const QString& key) const;
+
+    /**
+     * @brief Drops the model for `key` if it is resident and no processor holds it.
+     * @return True if it was dropped.
+     */
+    bool releaseIfIdle(const QString& key);
+
+    void setBudgetBytes(qint64 bytes); ///< 0 = unlimited; trims idle models right away
+    qint64 budgetBytes() const;
+    qint64 residentBytes() const;
+
+    /**
+     * @brief Estimated memory held by a module's tensors, including frozen graph constants.
+     */
+    static qint64 footprintBytes(const torch::jit::script::Module& module);
+
+private:
+    ModelRegistry();
+
+    struct Entry {
+        Handle module;
+        qint64 bytes = 0;
+        std::list<QString>::iterator lruPosition;
+    };
+
+    void touch(Entry& entry, const QString& key);
+    void evictIdleUntilFits(qint64 incomingBytes, const QString& keep);
+
+    mutable std::mutex m_mutex;    ///< Guards the maps and counters
+    std::mutex m_loadMutex;        ///< One load at a time; peak RAM stays predictable
+    std::map<QString, Entry> m_entries;
+    std::list<QString> m_lru;      ///< Front = most recently used
+    std::map<QString, qint64> m_knownBytes; ///< Footprints of models loaded before, to make room ahead of a reload
+    qint64 m_residentBytes = 0;
+    qint64 m_budgetBytes = 0;
+};
+
+#endif // MODELREGISTRY_H
@@ -0,0 +1,126 @@
+#include "overlapaddbuffer.h"
+#include <QDebug>
+#include <algorithm>
+
+OverlapAddBuffer::OverlapAddBuffer(int64_t chunkSize, int64_t step, float overlapRate, int64_t reserveLength)
+    : m_chunkSize(chunkSize),
+      m_step(step),
+      m_window(makeWindow(chunkSize, overlapRate)),
+      m_output(torch::zeros({std::max(reserveLength, chunkSize)}, torch::kFloat)),
+      m_weight(torch::zeros({std::max(reserveLength, chunkSize)}, torch::kFloat)),
+      m_base(0),
+      m_end(0)
+{
+}
+
+torch::Tensor OverlapAddBuffer::makeWindow(int64_t chunkSize, float overlapRate)
+{
+    torch::Tensor window = torch::ones({chunkSize}, torch::kFloat);
+    int64_t fadeLength = static_cast<int64_t>(chunkSize * std::min(overlapRate, 0.5f));
+    if (fadeLength > 0) {
+        window.slice(0, 0, fadeLength) = torch::linspace(0, 1, fadeLength);
+        window.slice(0, chunkSize - fadeLength, chunkSize) = torch::linspace(1, 0, fadeLength);
+    }
+    return window;
+}
+
+bool OverlapAddBuffer::addChunks(int64_t firstChunkIndex, const torch::Tensor& chunks)
+{
+    torch::Tensor flat = chunks.dim() == 3 ? chunks.squeeze(2) : chunks;
+    if (flat.dim() != 2 || flat.size(0) == 0 || flat.size(1) != m_chunkSize) {
+        qDebug() << "OverlapAddBuffer::addChunks - Invalid chunk shape";
+        return false;
+    }
+
+    int64_t numChunks = flat.size(0);
+    int64_t start = firstChunkIndex * m_step;
+    int64_t length = m_step * (numChunks - 1) + m_chunkSize;
+    if (start < m_base) {
+        qDebug() << "OverlapAddBuffer::addChunks - Chunk" << firstChunkIndex << "overlaps already finalized samples";
+        return false;
+    }
+
+    ensureCapacity(start + length);
+
+    torch::Tensor windowed = flat.to(torch::kFloat) * m_window;
+    torch::Tensor outputSlice = m_output.slice(0, start - m_base, start - m_base + length);
+    torch::Tensor weightSlice = m_weight.slice(0, start - m_base, start - m_base + length);
+
+    if (numChunks == 1) {
+        outputSlice.add_(windowed[0]);
+        weightSlice.add_(m_window);
+    } else {
+        // fold() scatters every chunk to its hop position in one call:
+        // columns (1, chunkSize, N) -> (1, 1, 1, length)
+        namespace F = torch::nn::functional;
+        auto foldOptions = F::FoldFuncOptions({1, length}, {1, m_chunkSize}).stride({1, m_step});
+
+        torch::Tensor columns = windowed.transpose(0, 1).unsqueeze(0);
+        outputSlice.add_(F::fold(columns, foldOptions).view({length}));
+
+        torch::Tensor weightColumns = m_window.unsqueeze(1).expand({m_chunkSize, numChunks}).unsqueeze(0);
+        weightSlice.add_(F::fold(weightColumns, foldOptions).view({length}));
+    }
+
+    m_end = std::max(m_end, start + length);
+    return true;
+}
+
+int64_t OverlapAddBuffer::finalizedEnd(int64_t nextChunkIndex) const
+{
+    return std::min(nextChunkIndex * m_step, m_end);
+}
+
+torch::Tensor OverlapAddBuffer::takeFinalized(int64_t endSample)
+{
+    endSample = std::min(endSample, m_end);
+    if (endSample <= m_base) {
+        return torch::empty({0}, torch::kFloat);
+    }
+
+    int64_t count = endSample - m_base;
+    torch::Tensor weight = m_weight.slice(0, 0, count);
+
+    // Normalize by weight to avoid amplitude scaling
+    torch::Tensor result = m_output.slice(0, 0, count)
+        / torch::where(weight == 0, torch::ones_like(weight), weight);
+
+    // Shift the still-open region to the front of the buffer
+    int64_t remaining = m_end - endSample;
+    if (remaining > 0) {
+        m_output.slice(0, 0, remaining).copy_(m_output.slice(0, count, count + remaining).clone());
+        m_weight.slice(0, 0, remaining).copy_(m_weight.slice(0, count, count + remaining).clone());
+    }
+    m_output.slice(0, remaining).zero_();
+    m_weight.slice(0, remaining).zero_();
+
+    m_base = endSample;
+    return result;
+}
+
+torch::Tensor OverlapAddBuffer::finish(int64_t totalLength)
+{
+    return takeFinalized(totalLength);
+}
+
+int64_t OverlapAddBuffer::position() const
+{
+    return m_base;
+}
+
+void OverlapAddBuffer::ensureCapacity(int64_t endSample)
+{
+    int64_t needed = endSample - m_base;
+    int64_t capacity = m_output.size(0);
+    if (needed <= capacity) {
+        return;
+    }
+
+    int64_t newCapacity = std::max(needed, capacity * 2);
+    torch::Tensor output = torch::zeros({newCapacity}, torch::kFloat);
+    torch::Tensor weight = torch::zeros({newCapacity}, torch::kFloat);
+    output.slice(0, 0, capacity).copy_(m_output);
+    weight.slice(0, 0, capacity).copy_(m_weight);
+    m_output = output;
+    m_weight = weight;
+}
@@ -0,0 +1,79 @@
+#ifndef OVERLAPADDBUFFER_H
+#define OVERLAPADDBUFFER_H
+
+#include <torch/torch.h>
+
+/**
+ * @brief Incremental overlap-add accumulator for separated chunks.
+ *
+ * Chunks are windowed and added in place as they come out of the model, so no
+ * intermediate chunk files are needed. The buffer only keeps the region that
+ * later chunks can still touch: samples before the start of the next chunk are
+ * final and can be taken out early (streaming) or all at once at the end.
+ */
+class OverlapAddBuffer
+{
+public:
+    /**
+     * @brief Constructs the buffer.
+     * @param chunkSize Number of samples per chunk.
+     * @param step Hop size between consecutive chunks in samples.
+     * @param overlapRate Overlap rate used to build the fade window.
+     * @param reserveLength Optional number of samples to pre-allocate.
+     */
+    OverlapAddBuffer(int64_t chunkSize, int64_t step, float overlapRate, int64_t reserveLength = 0);
+
+    /**
+     * @brief Builds the linear fade-in/fade-out window used for overlap-add.
+     * @param chunkSize Number of samples per chunk.
+     * @param overlapRate Overlap rate; the fade never exceeds half a chunk.
+     * @return 1D window tensor of length chunkSize.
+     */
+    static torch::Tensor makeWindow(int64_t chunkSize, float overlapRate);
+
+    /**
+     * @brief Adds consecutive chunks to the buffer.
+     * @param firstChunkIndex Index of the first chunk in the batch.
+     * @param chunks Tensor of shape (N, chunkSize, 1) or (N, chunkSize).
+     * @return False if the chunks are malformed or touch already-taken samples.
+     */
+    bool addChunks(int64_t firstChunkIndex, const torch::Tensor& chunks);
+
+    /**
+     * @brief Returns the absolute sample index before which no further chunk can contribute.
+     * @param nextChunkIndex Index of the next chunk that will be added.
+     */
+    int64_t finalizedEnd(int64_t nextChunkIndex) const;
+
+    /**
+     * @brief Removes and returns normalized samples up to endSample.
+     * @param endSample Absolute end sample (exclusive); clamped to the written region.
+     * @return 1D tensor of finalized samples (may be empty).
+     */
+    torch::Tensor takeFinalized(int64_t endSample);
+
+    /**
+     * @brief Returns all remaining samples, truncated to totalLength.
+     * @param totalLength Absolute length of the output signal.
+     * @return 1D tensor of the remaining normalized samples.
+     */
+    torch::Tensor finish(int64_t totalLength);
+
+    /**
+     * @brief Absolute index of the first sample not yet taken out.
+     */
+    int64_t position() const;
+
+private:
+    void ensureCapacity(int64_t endSample);
+
+    int64_t m_chunkSize;    ///< Samples per chunk
+    int64_t m_step;         ///< Hop size in samples
+    torch::Tensor m_window; ///< Fade window applied to every chunk
+    torch::Tensor m_output; ///< Accumulated weighted samples starting at m_base
+    torch::Tensor m_weight; ///< Accumulated window weights starting at m_base
+    int64_t m_base;         ///< Absolute sample index of m_output[0]
+    int64_t m_end;          ///< Absolute end of the region written so far
+};
+
+#endif // OVERLAPADDBUFFER_H
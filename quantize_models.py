@@ -0,0 +1,39 @@
+"""Export dynamically quantized (INT8) variants of the TorchScript models.
+
+libtorch has no C++ entry point for dynamic quantization of a scripted module,
+so the INT8 models the app loads for ModelPrecision::Int8 are produced here:
+
+    python quantize_models.py models/htsat_embedding_model.pt models/zero_shot_asp_separation_model.pt
+
+Each input X.pt is written next to it as X_int8.pt. Linear layers (including
+the projections inside attention blocks) get INT8 weights with activations
+quantized on the fly; everything else stays float32.
+"""
+
+import sys
+from pathlib import Path
+
+import torch
+from torch.ao.quantization import default_dynamic_qconfig, quantize_dynamic_jit
+
+
+def quantize(model_path: Path) -> Path:
+    model = torch.jit.load(str(model_path), map_location="cpu").eval()
+    quantized = quantize_dynamic_jit(model, {"": default_dynamic_qconfig})
+    output_path = model_path.with_name(model_path.stem + "_int8.pt")
+    torch.jit.save(quantized, str(output_path))
+    return output_path
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__)
+        return 1
+    torch.backends.quantized.engine = "fbgemm"
+    for path in argv[1:]:
+        print(f"{path} -> {quantize(Path(path))}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,84 @@
+#include "referencebackend.h"
+#include "constants.h"
+#include <ATen/Parallel.h>
+#include <torch/torch.h>
+#include <chrono>
+
+namespace {
+
+/**
+ * @brief Keeps the calling thread busy for `ms` milliseconds, like inference would.
+ */
+void spin(double ms)
+{
+    const auto deadline = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(ms));
+    volatile double sink = 0.0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (int i = 0; i < 1000; ++i) {
+            sink = sink + i * 0.5;
+        }
+    }
+}
+
+/**
+ * @brief Simulates `items` units of single-core work spread over the intra-op pool.
+ *
+ * Each item runs on one thread, so batching and ThreadBudget shares change the
+ * wall time the same way they do for the real models.
+ */
+void simulateCost(int64_t items, double msPerItem)
+{
+    if (items <= 0 || msPerItem <= 0.0) {
+        return;
+    }
+    at::parallel_for(0, items, 1, [msPerItem](int64_t begin, int64_t end) {
+        spin((end - begin) * msPerItem);
+    });
+}
+
+} // namespace
+
+ReferenceEmbeddingBackend::ReferenceEmbeddingBackend(double msPerClip)
+    : m_msPerClip(msPerClip)
+{
+}
+
+torch::Tensor ReferenceEmbeddingBackend::embed(const torch::Tensor& clips)
+{
+    TORCH_CHECK(clips.dim() == 2 && clips.size(1) > 0, "reference embed expects clips of shape (B, samples)");
+    c10::InferenceMode inferenceMode;
+    simulateCost(clips.size(0), m_msPerClip);
+
+    torch::Tensor envelope = torch::adaptive_avg_pool1d(clips.to(torch::kFloat).abs().unsqueeze(1),
+                                                        Constants::EMBEDDING_DIM).squeeze(1);
+    envelope = envelope - envelope.mean(1, true);
+    // Silent clips keep a zero embedding instead of dividing by zero
+    return envelope / envelope.norm(2, 1, true).clamp_min(1e-12);
+}
+
+QString ReferenceEmbeddingBackend::name() const
+{
+    return "reference";
+}
+
+ReferenceSeparationBackend::ReferenceSeparationBackend(double msPerChunk)
+    : m_msPerChunk(msPerChunk)
+{
+}
+
+torch::Tensor ReferenceSeparationBackend::separate(const torch::Tensor& waveform, const torch::Tensor& condition)
+{
+    TORCH_CHECK(waveform.dim() == 3 && condition.dim() == 2 && condition.size(0) == waveform.size(0),
+                "reference separate expects waveform (N, samples, 1) and condition (N, dim)");
+    c10::InferenceMode inferenceMode;
+    simulateCost(waveform.size(0), m_msPerChunk);
+
+    torch::Tensor gain = torch::sigmoid(condition.to(torch::kFloat).mean(1)).view({-1, 1, 1});
+    return waveform.to(torch::kFloat) * gain;
+}
+
+QString ReferenceSeparationBackend::name() const
+{
+    return "reference";
+}
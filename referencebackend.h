@@ -0,0 +1,49 @@
+#ifndef REFERENCEBACKEND_H
+#define REFERENCEBACKEND_H
+
+#include "inferencebackend.h"
+
+/**
+ * @brief Model-free embedding backend for development and benchmarking.
+ *
+ * The embedding is the clip's absolute-amplitude envelope pooled to
+ * EMBEDDING_DIM bins, centred and L2-normalised: deterministic, cheap, and
+ * different for different audio, so routing mistakes still show up in output.
+ */
+class ReferenceEmbeddingBackend : public EmbeddingBackend
+{
+public:
+    /**
+     * @param msPerClip Single-core milliseconds of simulated work per clip, spread over the intra-op pool.
+     */
+    explicit ReferenceEmbeddingBackend(double msPerClip);
+
+    torch::Tensor embed(const torch::Tensor& clips) override;
+    QString name() const override;
+
+private:
+    double m_msPerClip;
+};
+
+/**
+ * @brief Model-free separation backend for development and benchmarking.
+ *
+ * Each chunk is scaled by sigmoid(mean(condition)), so the output depends on
+ * both the audio and the query and overlap-add reconstructs a scaled input.
+ */
+class ReferenceSeparationBackend : public SeparationBackend
+{
+public:
+    /**
+     * @param msPerChunk Single-core milliseconds of simulated work per chunk and query.
+     */
+    explicit ReferenceSeparationBackend(double msPerChunk);
+
+    torch::Tensor separate(const torch::Tensor& waveform, const torch::Tensor& condition) override;
+    QString name() const override;
+
+private:
+    double m_msPerChunk;
+};
+
+#endif // REFERENCEBACKEND_H
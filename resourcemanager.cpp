@@ -7,13 +7,13 @@
 #include <QFileInfo>
 #include <QDebug>
 #include <QFile>
-#include <QTextStream>
 #include <vector>
 #include <QDateTime>
 #include <QCoreApplication>
 #include <QThread>
 #include "htsatworker.h"
 #include "separationworker.h"
+#include "separationtiers.h"
 #include <QMetaObject>
 
 static QThread* htsatThread = nullptr;
@@ -44,6 +44,7 @@ ResourceManager::ResourceManager(QObject* parent)
     m_fileTypeData[FileType::WavForSeparation] = FileTypeData();
 
     m_isProcessing = false;
+    m_isPaused = false;
 
 
     htsatThread = new QThread(this);
@@ -53,19 +54,55 @@ ResourceManager::ResourceManager(QObject* parent)
     connect(htsatThread, &QThread::finished, htsatWorker, &QObject::deleteLater);
     connect(this, &ResourceManager::startHTSATProcessing, htsatWorker, &HTSATWorker::generateFeatures);
     connect(htsatWorker, &HTSATWorker::progressUpdated, this, &ResourceManager::processingProgress);
-    connect(htsatWorker, &HTSATWorker::finished, this, [this](const std::vector<float>& avgEmb, const QString& outputFileName){
-        QString filePath = saveEmbedding(avgEmb, outputFileName);
+    connect(this, &ResourceManager::startHTSATUpdate, htsatWorker, &HTSATWorker::updateFeature);
+    connect(htsatWorker, &HTSATWorker::finished, this, [this](const FeatureRecord& record, const QString& outputFileName){
+        QString filePath = saveFeature(record, outputFileName);
         m_isProcessing = false;
         emit processingFinished(QStringList() << filePath);
         emit featuresUpdated();
+        startNextJob();
+    });
+    connect(htsatWorker, &HTSATWorker::featureUpdated, this,
+            [this](const FeatureRecord& record, const QString& featurePath, int embeddedFiles){
+        // The mean is rewritten under the same name, so separation jobs pick it up as before
+        const QString savedPath = rewriteFeature(record, featurePath);
+        m_isProcessing = false;
+        if (!savedPath.isEmpty()) {
+            emit processingReport(QString("%1: embedded %2 new file(s), %3 in total")
+                                  .arg(QFileInfo(savedPath).completeBaseName()).arg(embeddedFiles)
+                                  .arg(record.members.size()));
+            emit processingFinished(QStringList() << savedPath);
+            emit featuresUpdated();
+        } else {
+            emit processingError(QString("Failed to save feature: %1").arg(featurePath));
+        }
+        startNextJob();
     });
     connect(htsatWorker, &HTSATWorker::error, this, [this](const QString& error){
         m_isProcessing = false;
         emit processingError(error);
+        startNextJob();
+    });
+    connect(htsatWorker, &HTSATWorker::stopped, this, [this](){
+        onJobStopped(htsatWorker->jobControl());
+    });
+    connect(htsatWorker, &HTSATWorker::embeddingCacheUsed, this, [this](int hits, int misses){
+        emit processingReport(QString("Embedding cache: %1 of %2 files reused, %3 embedded")
+                              .arg(hits).arg(hits + misses).arg(misses));
+    });
+    connect(htsatWorker, &HTSATWorker::warmedUp, this, [this](bool ok){
+        setModelState(ModelKind::Embedding, ok ? ModelState::Ready : ModelState::Failed);
+    });
+    connect(htsatWorker, &HTSATWorker::modelReleased, this, [this](){
+        setModelState(ModelKind::Embedding, ModelState::NotLoaded);
     });
 
     htsatThread->start();
 
+    qRegisterMetaType<SeparationOptions>("SeparationOptions");
+    qRegisterMetaType<EmbeddingOptions>("EmbeddingOptions");
+    qRegisterMetaType<FeatureRecord>("FeatureRecord");
+
     separationThread = new QThread(this);
     separationWorker = new SeparationWorker();
     separationWorker->moveToThread(separationThread);
@@ -74,20 +111,87 @@ ResourceManager::ResourceManager(QObject* parent)
     connect(this, &ResourceManager::startSeparationProcessing, separationWorker, &SeparationWorker::processFile);
     connect(separationWorker, &SeparationWorker::progressUpdated, this, &ResourceManager::processingProgress);
     connect(separationWorker, &SeparationWorker::chunkReady, this, &ResourceManager::handleChunk);
-connect(separationWorker, &SeparationWorker::separationFinished, this, &ResourceManager::handleFinalResult);
 
-connect(separationWorker, &SeparationWorker::separationFinished, this, [this](const QString& audioPath){
+// The worker writes results on its own write stage; only report them here
+connect(separationWorker, &SeparationWorker::separationWritten, this,
+        [this](const QString& audioPath, const QString&, const QString& outputPath){
+    m_runningOutputs[audioPath]++;
+    emit separationProcessingFinished(QStringList() << outputPath);
+});
+
+connect(separationWorker, &SeparationWorker::jobEnded, this, [this](bool interrupted){
+    if (interrupted) {
+        onJobStopped(separationWorker->jobControl());
+        return;
+    }
     m_isProcessing = false;
-    QStringList results;
-    QString outputName = QFileInfo(audioPath).baseName() + "_separated.wav";
-    QString outputPath = Constants::SEPARATED_RESULT_DIR + "/" + outputName;
-    results << outputPath;
-    emit separationProcessingFinished(results);
+    // Errors with no output at all mean the job failed (e.g. the model or a feature
+    // could not be loaded); otherwise they are per-file and summarised at the end
+    const QStringList errors = m_runningErrors;
+    m_runningErrors.clear();
+    if (!errors.isEmpty() && m_runningOutputs.isEmpty()) {
+        emit processingError(errors.join("\n"));
+    } else {
+        emit processingFinished(QStringList());
+        if (!errors.isEmpty()) {
+            emit processingFinishedWithErrors(errors);
+        }
+    }
+    startNextJob();
+});
+
+connect(separationWorker, &SeparationWorker::chunksSkipped, this,
+        [this](const QString& audioPath, qint64 skipped, qint64 total){
+    qDebug() << "Separation gates skipped" << skipped << "of" << total << "chunks in" << audioPath;
+    if (skipped > 0) {
+        emit processingReport(QString("%1: skipped %2 of %3 chunks")
+                              .arg(QFileInfo(audioPath).fileName()).arg(skipped).arg(total));
+    }
+});
+
+connect(separationWorker, &SeparationWorker::precisionCompared, this,
+        [this](const QString& precision, double speedup, double snrDb){
+    emit processingReport(QString("%1 separation: %2x faster than float32, output SNR %3 dB vs float32")
+                          .arg(precision).arg(speedup, 0, 'f', 2).arg(snrDb, 0, 'f', 1));
+});
+
+connect(separationWorker, &SeparationWorker::warmedUp, this, [this](bool ok){
+    setModelState(ModelKind::Separation, ok ? ModelState::Ready : ModelState::Failed);
+});
+
+connect(separationWorker, &SeparationWorker::modelReleased, this, [this](){
+    setModelState(ModelKind::Separation, ModelState::NotLoaded);
 });
 
+connect(separationWorker, &SeparationWorker::realtimeFactorMeasured, this,
+        [this](const QString& tier, const QString& precision, double realtimeFactor){
+    if (tier.isEmpty()) {
+        return;
+    }
+    emit processingReport(QString("%1 tier (%2): realtime factor %3 (%4x faster than realtime)")
+                          .arg(tier, precision).arg(realtimeFactor, 0, 'f', 3).arg(1.0 / realtimeFactor, 0, 'f', 1));
+    // A job that ran another precision (fallback or override) does not stand for the tier
+    if (precision != SeparationTiers::precisionName(SeparationTiers::options(tier).precision)) {
+        return;
+    }
+    m_tierRealtimeFactors[tier] = realtimeFactor;
+    emit tierRealtimeFactorUpdated(tier, realtimeFactor);
+});
+
+connect(separationWorker, &SeparationWorker::precisionRefused, this,
+        [this](const QString& precision, const QString& reason){
+    emit processingReport(QString("%1 inference disabled, using float32: %2").arg(precision, reason));
+});
+
+// Per-file errors do not end the job; they go to the status bar and the
+// report at jobEnded. Errors outside a separation job (warm-up) show at once
 connect(separationWorker, &SeparationWorker::error, this, [this](const QString& error){
-    m_isProcessing = false;
-    emit processingError(error);
+    if (!m_isProcessing || m_runningJob.kind != ProcessingJob::Kind::Separation) {
+        emit processingError(error);
+        return;
+    }
+    m_runningErrors.append(error);
+    emit processingReport(error);
 });
 
     separationThread->start();
@@ -171,7 +275,7 @@ FolderWidget* ResourceManager::addFolder(const QString& folderPath, QWidget* fol
     QStringList fileFilters;
     QString fileTypeDescription;
     if (type == FileType::SoundFeature) {
-        fileFilters << "*.txt";
+        fileFilters << FeatureStore::featureFileFilters();
         fileTypeDescription = "sound feature";
     } else {
         fileFilters << "*.wav";
@@ -231,9 +335,11 @@ FileWidget* ResourceManager::addSingleFile(const QString& filePath, QWidget* fil
         return nullptr;
     }
 
-    QString expectedSuffix = (type == FileType::SoundFeature) ? "txt" : "wav";
+    QStringList expectedSuffixes = (type == FileType::SoundFeature)
+        ? QStringList() << Constants::FEATURE_EXTENSION.mid(1) << Constants::TXT_EXTENSION.mid(1)
+        : QStringList() << "wav";
 
-    if (fi.suffix().toLower() != expectedSuffix) {
+    if (!expectedSuffixes.contains(fi.suffix().toLower())) {
         qDebug() << "Invalid file type for" << static_cast<int>(type) << ":" << filePath;
         return nullptr;
     }
@@ -410,21 +516,321 @@ void ResourceManager::emitFolderRemoved(const QString& folderPath, FileType type
  * @brief Starts audio feature generation process.
  * @param filePaths List of file paths to process.
  * @param outputFileName Base name for output feature file.
+ * @param options Which part of each file is embedded and how window embeddings are pooled.
  */
-void ResourceManager::startGenerateAudioFeatures(const QStringList& filePaths, const QString& outputFileName)
+void ResourceManager::startGenerateAudioFeatures(const QStringList& filePaths, const QString& outputFileName,
+                                                 const EmbeddingOptions& options, JobPriority priority)
 {
-    if (m_isProcessing) return;
-    m_isProcessing = true;
-    emit processingStarted();
-    emit startHTSATProcessing(filePaths, outputFileName);
+    ProcessingJob job;
+    job.kind = ProcessingJob::Kind::Features;
+    job.priority = priority;
+    job.filePaths = filePaths;
+    job.outputFileName = outputFileName;
+    job.embeddingOptions = options;
+    enqueueJob(job);
+}
+
+/**
+ * @brief Adds files to a saved feature; only files it does not already hold are embedded.
+ * @param featureName Feature to extend (file name without extension).
+ * @param filePaths Files to add; members whose content changed are embedded again.
+ */
+void ResourceManager::startAddFilesToFeature(const QString& featureName, const QStringList& filePaths,
+                                             JobPriority priority)
+{
+    ProcessingJob job;
+    job.kind = ProcessingJob::Kind::Features;
+    job.priority = priority;
+    job.filePaths = filePaths;
+    job.updateFeaturePath = featurePathFor(featureName);
+    enqueueJob(job);
 }
 
-void ResourceManager::startSeparateAudio(const QStringList& filePaths, const QString& outputFileName)
+/**
+ * @brief Removes files from a saved feature and rewrites its mean from the remaining members.
+ * @param featureName Feature to shrink.
+ * @param filePaths Member files to drop.
+ * @return False if the feature has no saved members, nothing matched, or every member would go.
+ */
+bool ResourceManager::removeFilesFromFeature(const QString& featureName, const QStringList& filePaths)
 {
-    if (m_isProcessing) return;
+    const QString featurePath = featurePathFor(featureName);
+    FeatureRecord record;
+    QString errorMessage;
+    if (!FeatureStore::loadMembers(featurePath, &record, &errorMessage)) {
+        qDebug() << "ResourceManager::removeFilesFromFeature -" << errorMessage;
+        return false;
+    }
+    const size_t before = record.members.size();
+    if (FeatureStore::removeMembers(&record, filePaths) == 0 || record.members.empty()) {
+        qDebug() << "ResourceManager::removeFilesFromFeature - nothing removed from" << featureName
+                 << "(" << before << "members; a feature keeps at least one)";
+        return false;
+    }
+    if (rewriteFeature(record, featurePath).isEmpty()) {
+        return false;
+    }
+    emit featuresUpdated();
+    return true;
+}
+
+/**
+ * @brief Names of saved features that have member embeddings and can be updated incrementally.
+ */
+QStringList ResourceManager::updatableFeatures() const
+{
+    QStringList names;
+    QDir dir(Constants::OUTPUT_FEATURES_DIR);
+    for (const QString& file : dir.entryList(FeatureStore::featureFileFilters(), QDir::Files, QDir::Name)) {
+        if (QFile::exists(FeatureStore::membersPathFor(dir.filePath(file)))) {
+            names.append(QFileInfo(file).completeBaseName());
+        }
+    }
+    names.removeDuplicates();
+    return names;
+}
+
+/**
+ * @brief Starts audio separation for the given files.
+ * @param filePaths List of file paths to separate.
+ * @param featureName Name of the sound feature used as the query.
+ * @param options Per-job separation settings (e.g. inference batch size).
+ */
+void ResourceManager::startSeparateAudio(const QStringList& filePaths, const QString& featureName,
+                                         const SeparationOptions& options, JobPriority priority)
+{
+    startSeparateAudio(filePaths, QStringList() << featureName, options, priority);
+}
+
+/**
+ * @brief Starts audio separation for several features in a single pass.
+ *
+ * Each file is decoded and chunked once; every chunk is run against all query
+ * features in the same forward call, producing one output file per feature.
+ *
+ * @param filePaths List of file paths to separate.
+ * @param featureNames Names of the sound features used as queries.
+ * @param options Per-job separation settings.
+ */
+void ResourceManager::startSeparateAudio(const QStringList& filePaths, const QStringList& featureNames,
+                                         const SeparationOptions& options, JobPriority priority)
+{
+    ProcessingJob job;
+    job.kind = ProcessingJob::Kind::Separation;
+    job.priority = priority;
+    job.filePaths = filePaths;
+    job.featureNames = featureNames;
+    job.options = options;
+    enqueueJob(job);
+}
+
+/**
+ * @brief Queues a processing job and starts it if nothing is running.
+ *
+ * Jobs run one at a time, highest priority first and FIFO within a priority.
+ * A job with a higher priority than the running one preempts it at the next
+ * chunk (separation) or file (features) boundary.
+ *
+ * @param job The job to queue.
+ * @param resumed True for the unfinished part of a preempted job; it goes ahead of its priority peers.
+ */
+void ResourceManager::enqueueJob(const ProcessingJob& job, bool resumed)
+{
+    int index = 0;
+    while (index < m_jobQueue.size()
+           && (m_jobQueue[index].priority > job.priority
+               || (!resumed && m_jobQueue[index].priority == job.priority))) {
+        ++index;
+    }
+    m_jobQueue.insert(index, job);
+
+    if (m_isProcessing && job.priority > m_runningJob.priority) {
+        qDebug() << "ResourceManager: preempting the running job for a higher-priority one";
+        runningJobControl()->preempt();
+    }
+
+    startNextJob();
+}
+
+/**
+ * @brief Dispatches the next queued job to its worker if none is running.
+ */
+void ResourceManager::startNextJob()
+{
+    if (m_isProcessing || m_jobQueue.isEmpty()) {
+        return;
+    }
+
+    m_runningJob = m_jobQueue.takeFirst();
+    m_runningOutputs.clear();
+    m_runningErrors.clear();
     m_isProcessing = true;
+    m_isPaused = false;
+    runningJobControl()->reset();
+
+    // The worker runs the job as soon as its warm-up returns; the GUI never waits on it
+    const ModelKind kind = m_runningJob.kind == ProcessingJob::Kind::Features ? ModelKind::Embedding
+                                                                               : ModelKind::Separation;
+    if (modelState(kind) == ModelState::WarmingUp) {
+        emit processingReport("Waiting for the model to finish warming up...");
+    }
+
     emit processingStarted();
-    emit startSeparationProcessing(filePaths, outputFileName);
+    if (m_runningJob.kind == ProcessingJob::Kind::Features) {
+        if (m_runningJob.updateFeaturePath.isEmpty()) {
+            emit startHTSATProcessing(m_runningJob.filePaths, m_runningJob.outputFileName, m_runningJob.embeddingOptions);
+        } else {
+            emit startHTSATUpdate(m_runningJob.updateFeaturePath, m_runningJob.filePaths);
+        }
+    } else {
+        emit startSeparationProcessing(m_runningJob.filePaths, m_runningJob.featureNames, m_runningJob.options);
+    }
+}
+
+/**
+ * @brief Handles a job that stopped early, re-queueing the unfinished part of a preempted job.
+ * @param control Control of the worker that stopped.
+ */
+void ResourceManager::onJobStopped(JobControl* control)
+{
+    m_isProcessing = false;
+    m_isPaused = false;
+
+    if (control->stopReason() == JobControl::StopReason::Preempted) {
+        ProcessingJob remaining = m_runningJob;
+        if (remaining.kind == ProcessingJob::Kind::Separation) {
+            // Files with every output written are done; the rest start over later
+            remaining.filePaths.clear();
+            for (const QString& filePath : m_runningJob.filePaths) {
+                if (m_runningOutputs.value(filePath) < m_runningJob.featureNames.size()) {
+                    remaining.filePaths.append(filePath);
+                }
+            }
+        }
+        if (!remaining.filePaths.isEmpty()) {
+            enqueueJob(remaining, true);
+            return;
+        }
+    } else {
+        emit processingCancelled();
+    }
+
+    startNextJob();
+}
+
+JobControl* ResourceManager::runningJobControl() const
+{
+    return m_runningJob.kind == ProcessingJob::Kind::Features
+        ? htsatWorker->jobControl()
+        : separationWorker->jobControl();
+}
+
+/**
+ * @brief Cancels the running job.
+ *
+ * The worker stops at its next chunk or file boundary, discards unwritten
+ * results and releases the model. Queued jobs still run afterwards.
+ */
+void ResourceManager::cancelProcessing()
+{
+    if (m_isProcessing) {
+        runningJobControl()->cancel();
+    }
+}
+
+/**
+ * @brief Pauses the running job at its next chunk or file boundary.
+ */
+void ResourceManager::pauseProcessing()
+{
+    if (m_isProcessing && !m_isPaused) {
+        runningJobControl()->pause();
+        m_isPaused = true;
+        emit processingPaused(true);
+    }
+}
+
+/**
+ * @brief Resumes a paused job.
+ */
+void ResourceManager::resumeProcessing()
+{
+    if (m_isProcessing && m_isPaused) {
+        runningJobControl()->resume();
+        m_isPaused = false;
+        emit processingPaused(false);
+    }
+}
+
+bool ResourceManager::isProcessing() const
+{
+    return m_isProcessing;
+}
+
+bool ResourceManager::isProcessingPaused() const
+{
+    return m_isPaused;
+}
+
+/**
+ * @brief Releases the resident separation model to free memory.
+ *
+ * The request is queued on the separation thread, so a running job keeps its
+ * model until it finishes. The next separation job reloads the model on demand.
+ */
+void ResourceManager::releaseSeparationModel()
+{
+    if (separationWorker) {
+        QMetaObject::invokeMethod(separationWorker, "releaseModel", Qt::QueuedConnection);
+        setModelState(ModelKind::Separation, ModelState::NotLoaded);
+    }
+}
+
+/**
+ * @brief Loads both models and runs one dummy forward each on their worker threads.
+ *
+ * Jobs requested meanwhile are queued on the same threads and start once the
+ * warm-up returns. Progress is reported through modelStateChanged().
+ */
+void ResourceManager::warmUpModels()
+{
+    if (htsatWorker && modelState(ModelKind::Embedding) != ModelState::Ready) {
+        setModelState(ModelKind::Embedding, ModelState::WarmingUp);
+        QMetaObject::invokeMethod(htsatWorker, "warmUp", Qt::QueuedConnection);
+    }
+    if (separationWorker && modelState(ModelKind::Separation) != ModelState::Ready) {
+        setModelState(ModelKind::Separation, ModelState::WarmingUp);
+        QMetaObject::invokeMethod(separationWorker, "warmUp", Qt::QueuedConnection);
+    }
+}
+
+void ResourceManager::setDefaultSeparationTier(const QString& tier)
+{
+    m_defaultTier = tier;
+}
+
+QString ResourceManager::defaultSeparationTier() const
+{
+    return m_defaultTier.isEmpty() ? SeparationTiers::STANDARD : m_defaultTier;
+}
+
+double ResourceManager::tierRealtimeFactor(const QString& tier) const
+{
+    return m_tierRealtimeFactors.value(tier, -1.0);
+}
+
+ResourceManager::ModelState ResourceManager::modelState(ModelKind kind) const
+{
+    return m_modelStates.value(kind, ModelState::NotLoaded);
+}
+
+void ResourceManager::setModelState(ModelKind kind, ModelState state)
+{
+    if (m_modelStates.value(kind, ModelState::NotLoaded) == state) {
+        return;
+    }
+    m_modelStates[kind] = state;
+    emit modelStateChanged(kind, state);
 }
 
 void ResourceManager::autoLoadSoundFeatures()
@@ -445,10 +851,10 @@ void ResourceManager::removeFeature(const QString& featureName)
         return;
     }
 
-    QStringList featureFiles = dir.entryList(QStringList() << "*.txt", QDir::Files);
+    QStringList featureFiles = dir.entryList(FeatureStore::featureFileFilters(), QDir::Files);
     QString fileToDelete;
     for (const QString& file : featureFiles) {
-        if (file.startsWith(featureName + "_") || file == featureName + ".txt") {
+        if (file.startsWith(featureName + "_") || QFileInfo(file).completeBaseName() == featureName) {
             fileToDelete = dir.absoluteFilePath(file);
             break;
         }
@@ -461,6 +867,12 @@ void ResourceManager::removeFeature(const QString& featureName)
 
     QFile file(fileToDelete);
     if (file.remove()) {
+        // A legacy .txt copy under the same name would otherwise reappear in the list
+        const QFileInfo deleted(fileToDelete);
+        for (const QString& extension : {Constants::FEATURE_EXTENSION, Constants::TXT_EXTENSION}) {
+            QFile::remove(deleted.path() + "/" + deleted.completeBaseName() + extension);
+        }
+        QFile::remove(FeatureStore::membersPathFor(fileToDelete));
         qDebug() << "Deleted feature file:" << fileToDelete;
         emit featuresUpdated();
     } else {
@@ -524,7 +936,7 @@ bool ResourceManager::saveWav(const torch::Tensor& waveform, const QString& file
 }
 
 /**
- * @brief Saves an averaged embedding vector to a text file.
+ * @brief Saves an averaged embedding vector as a new feature file.
  * @param embedding Vector of floats.
  * @param outputFileName Base name for the output file.
  * @return Path to the saved file, or empty string if failed.
@@ -539,6 +951,53 @@ QString ResourceManager::saveEmbedding(const std::vector<float>& embedding, cons
     }
 }
 
+/**
+ * @brief Saves a feature's mean embedding and, next to it, the member embeddings it was averaged from.
+ * @param record Members and settings of the new feature.
+ * @param outputFileName Base name for the output file.
+ * @return Path to the saved feature file, or empty string if failed.
+ */
+QString ResourceManager::saveFeature(const FeatureRecord& record, const QString& outputFileName)
+{
+    QString filePath = createOutputFilePath(outputFileName);
+    if (filePath.isEmpty() || !saveEmbeddingToFile(record.mean(), filePath, record.modelVersion,
+                                                   static_cast<quint32>(record.members.size()))) {
+        return QString();
+    }
+    if (!FeatureStore::saveMembers(filePath, record)) {
+        qDebug() << "Feature saved without member embeddings; it cannot be updated incrementally:" << filePath;
+    }
+    return filePath;
+}
+
+/**
+ * @brief Rewrites an existing feature from its members; a legacy .txt feature is replaced by a .feat.
+ * @param record Updated members of the feature.
+ * @param featurePath Current feature file.
+ * @return Path of the rewritten feature file, or empty string if failed.
+ */
+QString ResourceManager::rewriteFeature(const FeatureRecord& record, const QString& featurePath)
+{
+    const QString binaryPath = FeatureStore::binaryPathFor(featurePath);
+    if (!saveEmbeddingToFile(record.mean(), binaryPath, record.modelVersion,
+                             static_cast<quint32>(record.members.size()))
+        || !FeatureStore::saveMembers(binaryPath, record)) {
+        return QString();
+    }
+    if (binaryPath != featurePath) {
+        FeatureStore::retireTextFeature(featurePath);
+    }
+    return binaryPath;
+}
+
+/**
+ * @brief Path of the saved feature file for a feature name.
+ */
+QString ResourceManager::featurePathFor(const QString& featureName)
+{
+    return FeatureStore::featurePathFor(featureName);
+}
+
 /**
  * @brief Creates a unique output file path in the features directory.
  * @param outputFileName Desired base name for the file.
@@ -561,37 +1020,32 @@ QString ResourceManager::createOutputFilePath(const QString& outputFileName)
         baseName = "output";
     }
 
-    QString candidate = outputFolder + "/" + baseName + "_" + timestamp + ".txt";
+    QString candidate = outputFolder + "/" + baseName + "_" + timestamp + Constants::FEATURE_EXTENSION;
     int counter = 1;
     while (QFile::exists(candidate)) {
-        candidate = outputFolder + "/" + baseName + "_" + timestamp + "_" + QString::number(counter) + ".txt";
+        candidate = outputFolder + "/" + baseName + "_" + timestamp + "_" + QString::number(counter)
+                    + Constants::FEATURE_EXTENSION;
         counter++;
     }
     return candidate;
 }
 
 /**
- * @brief Saves an embedding vector to a specified text file.
+ * @brief Saves an embedding vector to a specified feature file in the binary format.
  * @param embedding Vector of floats.
  * @param filePath Absolute path of the output file.
+ * @param modelVersion Embedding model the vector came from; empty if unknown.
+ * @param memberCount Number of reference files averaged into the vector; 0 if unknown.
  * @return True if saving succeeded, false otherwise.
  */
-bool ResourceManager::saveEmbeddingToFile(const std::vector<float>& embedding, const QString& filePath)
+bool ResourceManager::saveEmbeddingToFile(const std::vector<float>& embedding, const QString& filePath,
+                                          const QString& modelVersion, quint32 memberCount)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << "Failed to open output file:" << filePath;
+    if (!FeatureStore::writeFeatureFile(filePath, {embedding}, modelVersion, memberCount)) {
+        qDebug() << "Failed to write output file:" << filePath;
         return false;
     }
 
-    QTextStream out(&file);
-    for (size_t i = 0; i < embedding.size(); ++i) {
-        out << embedding[i];
-        if (i < embedding.size() - 1) out << " ";
-    }
-    out << "\n";
-    file.close();
-
     qDebug() << "Averaged embedding saved to:" << filePath;
     return true;
 }
@@ -649,9 +1103,3 @@ void ResourceManager::handleChunk(const QString& chunkFilePath, const QString& f
     saveWav(chunkData, chunkFilePath);
 }
 
-void ResourceManager::handleFinalResult(const QString& audioPath, const QString& featureName, const torch::Tensor& finalTensor)
-{
-    QString outputName = QFileInfo(audioPath).baseName() + "_separated.wav";
-    QString outputPath = Constants::SEPARATED_RESULT_DIR + "/" + outputName;
-    saveWav(finalTensor, outputPath);
-}
@@ -8,6 +8,8 @@
 #include <QtGlobal>
 #include "folderwidget.h"
 #include "filewidget.h"
+#include "separationworker.h"
+#include "htsatworker.h"
 #include <vector>
 #ifndef Q_MOC_RUN
 #undef slots
@@ -33,6 +35,13 @@ public:
     // Singleton instance
     static ResourceManager* instance();
 
+    // Processing job priority; a higher-priority job preempts a running lower one
+    enum class JobPriority {
+        Low,
+        Normal,
+        High
+    };
+
     // File types
     enum class FileType {
         WavForFeature,      ///< WAV files used to generate sound feature vectors
@@ -60,15 +69,47 @@ public:
     // =========================
     // Audio / Feature Processing
     // =========================
-    void startGenerateAudioFeatures(const QStringList& filePaths, const QString& outputFileName); // Async HTSAT
-    void startSeparateAudio(const QStringList& filePaths, const QString& featureName);         // Async separation
+    void startGenerateAudioFeatures(const QStringList& filePaths, const QString& outputFileName,
+                                    const EmbeddingOptions& options = EmbeddingOptions(),
+                                    JobPriority priority = JobPriority::Normal);                // Async HTSAT
+    void startAddFilesToFeature(const QString& featureName, const QStringList& filePaths,
+                                JobPriority priority = JobPriority::Normal);                    // Async HTSAT, new files only
+    bool removeFilesFromFeature(const QString& featureName, const QStringList& filePaths);      // No model needed; updates the mean in place
+    QStringList updatableFeatures() const;                                                      // Features saved with member embeddings
+    void startSeparateAudio(const QStringList& filePaths, const QString& featureName,
+                            const SeparationOptions& options = SeparationOptions(),
+                            JobPriority priority = JobPriority::Normal);                        // Async separation
+    void startSeparateAudio(const QStringList& filePaths, const QStringList& featureNames,
+                            const SeparationOptions& options = SeparationOptions(),
+                            JobPriority priority = JobPriority::Normal);                        // One pass, one output per feature
+    void releaseSeparationModel();                                                              // Free resident ZeroShotASP model
+    void cancelProcessing();                                                                    // Stop the running job, discard its output
+    void pauseProcessing();                                                                     // Hold the running job at the next chunk/file
+    void resumeProcessing();
+    bool isProcessing() const;
+    bool isProcessingPaused() const;
+
+    // Model readiness: both models are loaded and warmed up on their worker threads
+    enum class ModelKind { Embedding, Separation };
+    enum class ModelState { NotLoaded, WarmingUp, Ready, Failed };
+    void warmUpModels();                                                                        // Background load + dummy forward
+    ModelState modelState(ModelKind kind) const;
+
+    // Separation tiers (SeparationTiers): default selection and measured realtime factors
+    void setDefaultSeparationTier(const QString& tier);
+    QString defaultSeparationTier() const;
+    double tierRealtimeFactor(const QString& tier) const;                                       // < 0 until a job has run
 
     // =========================
     // File saving interfaces for workers
     // =========================
     QString createOutputFilePath(const QString& outputFileName);                     // HTSAT feature
-    bool saveEmbeddingToFile(const std::vector<float>& embedding, const QString& filePath);
+    bool saveEmbeddingToFile(const std::vector<float>& embedding, const QString& filePath,
+                             const QString& modelVersion = QString(), quint32 memberCount = 0);
     QString saveEmbedding(const std::vector<float>& embedding, const QString& outputFileName);
+    QString saveFeature(const FeatureRecord& record, const QString& outputFileName);  // Mean plus member embeddings
+    QString rewriteFeature(const FeatureRecord& record, const QString& featurePath);   // Updated members; .txt -> .feat
+    static QString featurePathFor(const QString& featureName);
 
     QString createTempFilePath(const QString& baseName, int index, FileType type = FileType::TempSegment); // Temp chunk
     bool saveWav(const torch::Tensor& waveform, const QString& filePath, int sampleRate = 32000);          // Temp chunk or SeparationResult
@@ -107,9 +148,18 @@ signals:
     void processingProgress(int value);
     void processingFinished(const QStringList& results);
     void separationProcessingFinished(const QStringList& results);
-    void processingError(const QString& error);
-    void startHTSATProcessing(const QStringList& filePaths, const QString& outputFileName);
-    void startSeparationProcessing(const QStringList& filePaths, const QString& featureName);
+    void processingError(const QString& error);                 // The job failed; nothing was produced
+    void processingFinishedWithErrors(const QStringList& errors); // After processingFinished: per-file errors of the job
+    void processingCancelled();
+    void processingPaused(bool paused);
+    void processingReport(const QString& message);
+    void modelStateChanged(ResourceManager::ModelKind kind, ResourceManager::ModelState state);
+    void tierRealtimeFactorUpdated(const QString& tier, double realtimeFactor);
+    void startHTSATProcessing(const QStringList& filePaths, const QString& outputFileName,
+                              const EmbeddingOptions& options);
+    void startHTSATUpdate(const QString& featurePath, const QStringList& filePaths);
+    void startSeparationProcessing(const QStringList& filePaths, const QStringList& featureNames,
+                                   const SeparationOptions& options);
 
 private:
     // Singleton pattern
@@ -127,6 +177,34 @@ private:
     QSet<QString> m_lockedFiles;
     bool m_isProcessing;
 
+    // Processing job queue (one job runs at a time, highest priority first)
+    struct ProcessingJob {
+        enum class Kind { Features, Separation };
+        Kind kind = Kind::Separation;
+        JobPriority priority = JobPriority::Normal;
+        QStringList filePaths;
+        QString outputFileName;       ///< Features only
+        QString updateFeaturePath;    ///< Features only: existing feature the files are added to
+        QStringList featureNames;     ///< Separation only
+        SeparationOptions options;    ///< Separation only
+        EmbeddingOptions embeddingOptions; ///< Features only
+    };
+    QList<ProcessingJob> m_jobQueue;
+    ProcessingJob m_runningJob;
+    QMap<QString, int> m_runningOutputs; ///< Outputs written per input file of the running separation job
+    QStringList m_runningErrors;         ///< Errors of the running separation job, reported when it ends
+    bool m_isPaused;
+    QMap<ModelKind, ModelState> m_modelStates;
+    QString m_defaultTier;
+    QMap<QString, double> m_tierRealtimeFactors; ///< Last measured processing time / audio duration per tier
+
+    void setModelState(ModelKind kind, ModelState state);
+
+    void enqueueJob(const ProcessingJob& job, bool resumed = false);
+    void startNextJob();
+    void onJobStopped(JobControl* control);
+    JobControl* runningJobControl() const;
+
     // Private helpers
     bool isDuplicate(const QString& path, FileType type) const;
     void emitFileAdded(const QString& path, FileType type);
@@ -138,11 +216,6 @@ private:
                  const QString& featureName,
                  const torch::Tensor& chunkData);
 
-                 // 接收單檔案最終結果
-    void handleFinalResult(const QString& audioPath,
-                       const QString& featureName,
-                       const torch::Tensor& finalTensor);
-
 };
 
 #endif // RESOURCEMANAGER_H
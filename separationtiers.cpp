@@ -0,0 +1,51 @@
+#include "separationtiers.h"
+#include "constants.h"
+
+namespace SeparationTiers {
+
+QStringList names()
+{
+    return {DRAFT, STANDARD, ARCHIVAL};
+}
+
+SeparationOptions options(const QString& tier, bool* ok)
+{
+    const QString name = tier.trimmed().toLower();
+    SeparationOptions options;
+    options.tier = STANDARD;
+    if (ok) *ok = true;
+
+    if (name == DRAFT) {
+        options.tier = DRAFT;
+        options.overlapRate = Constants::DRAFT_OVERLAP_RATE;
+        options.precision = ModelPrecision::Int8;
+        options.batchSize = Constants::DRAFT_BATCH_SIZE;
+    } else if (name == ARCHIVAL) {
+        options.tier = ARCHIVAL;
+        options.overlapRate = Constants::ARCHIVAL_OVERLAP_RATE;
+        // Nothing is skipped: near-silent chunks are separated too
+        options.silenceRmsThreshold = 0.0f;
+        options.silencePeakThreshold = 0.0f;
+    } else if (name != STANDARD && ok) {
+        *ok = false;
+    }
+    return options;
+}
+
+QString describe(const QString& tier)
+{
+    const SeparationOptions tierOptions = options(tier);
+    return QString("%1 overlap, %2, batch %3")
+        .arg(tierOptions.overlapRate, 0, 'g', 2).arg(precisionName(tierOptions.precision)).arg(tierOptions.batchSize);
+}
+
+QString precisionName(ModelPrecision precision)
+{
+    switch (precision) {
+    case ModelPrecision::Int8: return "INT8";
+    case ModelPrecision::BFloat16: return "BF16";
+    default: return "float32";
+    }
+}
+
+} // namespace SeparationTiers
@@ -0,0 +1,49 @@
+#ifndef SEPARATIONTIERS_H
+#define SEPARATIONTIERS_H
+
+#include <QString>
+#include <QStringList>
+#include "separationworker.h"
+
+/**
+ * @brief Named speed/quality presets for separation jobs.
+ *
+ * A tier fixes the chunk overlap, model precision, batching and silence gate:
+ *  - "draft": 0.25 overlap, INT8 models, larger batches (interactive previews)
+ *  - "standard": the defaults (0.5 overlap, float32)
+ *  - "archival": 0.75 overlap, float32, every chunk separated (final renders)
+ *
+ * Other SeparationOptions fields keep their defaults and can still be changed
+ * after a tier is applied.
+ */
+namespace SeparationTiers {
+
+const QString DRAFT = "draft";
+const QString STANDARD = "standard";
+const QString ARCHIVAL = "archival";
+
+/**
+ * @brief Tier names, fastest first.
+ */
+QStringList names();
+
+/**
+ * @brief Options for a tier.
+ * @param tier Tier name (case-insensitive).
+ * @param ok Set to false for an unknown name (optional); the standard tier is returned then.
+ */
+SeparationOptions options(const QString& tier, bool* ok = nullptr);
+
+/**
+ * @brief Short description of what a tier sets, e.g. "0.25 overlap, INT8, batch 8".
+ */
+QString describe(const QString& tier);
+
+/**
+ * @brief Display name of a model precision: "float32", "INT8" or "BF16".
+ */
+QString precisionName(ModelPrecision precision);
+
+} // namespace SeparationTiers
+
+#endif // SEPARATIONTIERS_H
@@ -2,58 +2,479 @@
 #include "separationworker.h"
 #include <QFile>
 #include <QFileInfo>
-#include <QTextStream>
 #include <QDebug>
 #include <QDir>
+#include <QResource>
 #include <torch/torch.h>
 #include <cmath>
+#include <limits>
+#include <algorithm>
 #include "audio_preprocess_utils.h"
+#include "overlapaddbuffer.h"
+#include "audiostream.h"
+#include "workstealingpool.h"
+#include "threadbudget.h"
+#include "modelregistry.h"
+#include "htsatprocessor.h"
+#include "featurestore.h"
+#include "separationtiers.h"
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief A decoded input waiting for the inference stage.
+ */
+struct DecodedAudio
+{
+    QString audioPath;
+    torch::Tensor waveform; ///< (totalSamples) mono at AUDIO_SAMPLE_RATE
+};
+
+/**
+ * @brief A fully separated file waiting for the write stage.
+ */
+struct SeparatedResult
+{
+    QString audioPath;
+    QStringList featureNames;
+    std::vector<torch::Tensor> outputs; ///< One (totalSamples) waveform per feature
+};
+
+/**
+ * @brief State shared by every task of one scheduled separation job.
+ */
+struct ScheduledJob
+{
+    QStringList featureNames;
+    torch::Tensor conditions; ///< (numFeatures, 2048)
+    SeparationOptions options;
+    int64_t step = 0;
+    int totalFiles = 0;
+    BoundedQueue<SeparatedResult>* writeQueue = nullptr; ///< Write stage for finished files
+
+    std::mutex queueMutex;
+    QStringList pendingFiles; ///< Files not yet handed to a decode task
+    QStringList longFiles;    ///< Files over the streaming threshold, left for the streaming path
+
+    std::mutex progressMutex;
+    double progress = 0.0;    ///< Completed fraction of the whole job
+};
+
+/**
+ * @brief A decoded file whose chunk batches are in flight on the pool.
+ */
+struct ScheduledFile
+{
+    QString audioPath;
+    torch::Tensor windows;    ///< (numChunks, clipSamples) view over the padded input
+    int64_t totalSamples = 0;
+    int64_t numChunks = 0;
+    torch::Tensor keepMask;   ///< (numChunks) bool from the similarity pre-pass, undefined when disabled
+
+    std::mutex bufferMutex;
+    std::vector<std::unique_ptr<OverlapAddBuffer>> buffers; ///< One per feature
+    std::atomic<int64_t> remainingBatches{0};
+    std::atomic<int64_t> skippedChunks{0};
+    std::atomic<bool> failed{false};
+};
+
+namespace {
+
+using SeparationTiers::precisionName;
+
+// bf16 reuses the float32 model files, cast at load time
+torch::ScalarType precisionDtype(ModelPrecision precision)
+{
+    return precision == ModelPrecision::BFloat16 ? torch::kBFloat16 : torch::kFloat;
+}
+
+/**
+ * @brief ModelRegistry keys an HTSAT variant can be loaded under: from its resource or its file.
+ */
+QStringList embeddingModelKeys(ModelPrecision precision)
+{
+    const bool int8 = precision == ModelPrecision::Int8;
+    const torch::ScalarType dtype = precisionDtype(precision);
+    return {ModelRegistry::keyFor(int8 ? Constants::HTSAT_INT8_MODEL_RESOURCE : Constants::HTSAT_MODEL_RESOURCE, dtype),
+            ModelRegistry::keyFor(int8 ? Constants::HTSAT_INT8_MODEL_PATH : Constants::HTSAT_MODEL_PATH, dtype)};
+}
+
+bool embeddingModelResident(ModelPrecision precision)
+{
+    for (const QString& key : embeddingModelKeys(precision)) {
+        if (ModelRegistry::instance().isResident(key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool loadEmbeddingModel(HTSATProcessor* model, ModelPrecision precision)
+{
+    const bool int8 = precision == ModelPrecision::Int8;
+    const torch::ScalarType dtype = precisionDtype(precision);
+    if (!model->loadModelFromResource(int8 ? Constants::HTSAT_INT8_MODEL_RESOURCE
+                                           : Constants::HTSAT_MODEL_RESOURCE, dtype)) {
+        qDebug() << "Failed to load HTSAT model from resource, trying absolute path...";
+        return model->loadModel(int8 ? Constants::HTSAT_INT8_MODEL_PATH : Constants::HTSAT_MODEL_PATH, dtype);
+    }
+    return true;
+}
+
+} // namespace
 
 SeparationWorker::SeparationWorker(QObject* parent)
     : QObject(parent),
+      leasedCores(std::max(1, QThread::idealThreadCount())),
+      extractor(new ZeroShotASPFeatureExtractor(this)),
+      embeddingModel(nullptr),
+      embeddingPrecision(ModelPrecision::Float32),
+      jobPrecision(ModelPrecision::Float32),
       overlapRate(Constants::AUDIO_OVERLAP_RATE),
       clipSamples(Constants::AUDIO_CLIP_SAMPLES)
 {
 }
 
-torch::Tensor SeparationWorker::loadFeature(const QString& featurePath)
+SeparationWorker::~SeparationWorker() = default;
+
+ZeroShotASPFeatureExtractor* SeparationWorker::extractorFor(ModelPrecision precision)
 {
-    QFileInfo fi(featurePath);
-    if (!fi.exists() || !fi.isReadable()) {
-        emit error(QString("Feature file does not exist or is not readable: %1").arg(featurePath));
-        return torch::Tensor();
+    if (precision == ModelPrecision::Float32) {
+        return extractor;
+    }
+
+    ZeroShotASPFeatureExtractor*& variant = variantExtractors[precision];
+    if (!variant) {
+        variant = new ZeroShotASPFeatureExtractor(this);
+    }
+    return variant;
+}
+
+/**
+ * @brief Drops this worker's handle on a separation model and frees it in ModelRegistry unless another user holds it.
+ * @return True if the model was loaded.
+ */
+bool SeparationWorker::unloadExtractor(ZeroShotASPFeatureExtractor* model)
+{
+    if (!model || !model->isModelLoaded()) {
+        return false;
+    }
+    const QString key = model->registryKey();
+    model->unloadModel();
+    ModelRegistry::instance().releaseIfIdle(key);
+    return true;
+}
+
+bool SeparationWorker::ensureModelLoaded(ModelPrecision precision)
+{
+    ZeroShotASPFeatureExtractor* model = extractorFor(precision);
+    if (model->isModelLoaded()) {
+        return true;
+    }
+
+    const bool int8 = precision == ModelPrecision::Int8;
+    const torch::ScalarType dtype = precisionDtype(precision);
+    if (!model->loadModelFromResource(int8 ? Constants::ZERO_SHOT_ASP_INT8_MODEL_RESOURCE
+                                           : Constants::ZERO_SHOT_ASP_MODEL_RESOURCE, dtype)) {
+        qDebug() << "Failed to load ZeroShotASP model from resource, trying absolute path...";
+        if (!model->loadModel(int8 ? Constants::ZERO_SHOT_ASP_INT8_MODEL_PATH
+                                   : Constants::ZERO_SHOT_ASP_MODEL_PATH, dtype)) {
+            emit error(QString("Failed to load %1 separation model").arg(precisionName(precision)));
+            return false;
+        }
+    }
+
+    qDebug() << "SeparationWorker: ZeroShotASP model is now resident" << precisionName(precision);
+    return true;
+}
+
+ModelPrecision SeparationWorker::gateEmbeddingPrecision(ModelPrecision precision) const
+{
+    // The gate only ranks regions, so the float32 HTSAT that feature jobs keep
+    // warm is used rather than loading a second copy in the job's precision
+    if (precision == ModelPrecision::Float32 || embeddingModelResident(precision)) {
+        return precision;
+    }
+    if ((embeddingModel && embeddingModel->isModelLoaded() && embeddingPrecision == ModelPrecision::Float32)
+        || embeddingModelResident(ModelPrecision::Float32)) {
+        return ModelPrecision::Float32;
+    }
+    return precision;
+}
+
+bool SeparationWorker::ensureEmbeddingModelLoaded(ModelPrecision precision)
+{
+    if (embeddingModel && embeddingModel->isModelLoaded() && embeddingPrecision == precision) {
+        return true;
     }
 
-    QFile file(featurePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        emit error(QString("Failed to open feature file: %1").arg(featurePath));
+    delete embeddingModel;
+    embeddingModel = new HTSATProcessor(this);
+    embeddingPrecision = precision;
+
+    if (!loadEmbeddingModel(embeddingModel, precision)) {
+        return false;
+    }
+
+    qDebug() << "SeparationWorker: HTSAT model loaded for similarity gating" << precisionName(precision);
+    return true;
+}
+
+/**
+ * @brief Reference chunk for precision checks: the first window of an input, (1, clipSamples).
+ * @return An undefined tensor if the file cannot be read.
+ */
+torch::Tensor SeparationWorker::referenceClip(const QString& audioPath) const
+{
+    AudioStreamReader reader(Constants::AUDIO_SAMPLE_RATE);
+    if (!reader.open(audioPath)) {
         return torch::Tensor();
     }
+    torch::Tensor clip = reader.read(clipSamples);
+    return torch::constant_pad_nd(clip, {0, clipSamples - clip.size(0)}, 0).view({1, clipSamples});
+}
+
+/**
+ * @brief Times the separation model at a reduced precision against float32 on one chunk.
+ * @return Output SNR vs float32 in dB, -infinity if the reduced-precision model fails to run,
+ *         or NaN if the reference could not be computed.
+ */
+double SeparationWorker::comparePrecision(const QString& audioPath, const torch::Tensor& condition,
+                                          ModelPrecision precision)
+{
+    torch::Tensor clip = referenceClip(audioPath);
+    if (!clip.defined()) {
+        return std::nan("");
+    }
+    clip = clip.unsqueeze(2);
 
-    QTextStream in(&file);
-    QString content = in.readAll();
-    file.close();
+    // One untimed warm-up forward, then the average of PRECISION_BENCHMARK_RUNS
+    auto timeForward = [&](ZeroShotASPFeatureExtractor* model, torch::Tensor& output) {
+        output = processChunk(clip, condition, model);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < Constants::PRECISION_BENCHMARK_RUNS && output.defined(); ++i) {
+            output = processChunk(clip, condition, model);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / Constants::PRECISION_BENCHMARK_RUNS;
+    };
 
-    QStringList parts = content.split(' ', Qt::SkipEmptyParts);
-    std::vector<float> values;
-    bool ok = true;
-    for (const QString& part : parts) {
-        float val = part.toFloat(&ok);
-        if (!ok) {
-            emit error(QString("Invalid float value in feature file: %1").arg(part));
-            return torch::Tensor();
+    torch::Tensor reference;
+    torch::Tensor candidate;
+    const double referenceMs = timeForward(extractor, reference);
+    const double candidateMs = timeForward(extractorFor(precision), candidate);
+    if (!reference.defined()) {
+        return std::nan("");
+    }
+    if (!candidate.defined() || candidateMs <= 0.0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    const QString name = precisionName(precision);
+    const double snrDb = AudioPreprocessUtils::signalToNoiseDb(reference, candidate);
+    qDebug() << "SeparationWorker:" << name << "forward" << candidateMs << "ms vs float32" << referenceMs
+             << "ms, output SNR vs float32" << snrDb << "dB";
+    emit precisionCompared(name, referenceMs / candidateMs, snrDb);
+    return snrDb;
+}
+
+/**
+ * @brief Cosine similarity between the float32 and reduced-precision HTSAT embeddings of one chunk.
+ * @return The similarity, -1 if the reduced-precision model fails to run, or NaN if the reference could not be computed.
+ */
+double SeparationWorker::compareEmbeddingPrecision(const QString& audioPath, ModelPrecision precision)
+{
+    torch::Tensor clip = referenceClip(audioPath);
+    if (!clip.defined()) {
+        return std::nan("");
+    }
+
+    // Both precisions come from ModelRegistry one after the other. The float32 reference
+    // reuses a resident HTSAT, and one loaded only for this check is released before
+    // the candidate loads. The candidate is loaded as the gate's own model, which the
+    // job goes on to use if the check passes.
+    const bool referenceWasResident = embeddingModelResident(ModelPrecision::Float32);
+    torch::Tensor referenceEmbedding;
+    {
+        HTSATProcessor reference;
+        if (loadEmbeddingModel(&reference, ModelPrecision::Float32)) {
+            referenceEmbedding = reference.processBatch(clip);
+        }
+    }
+    if (!referenceWasResident) {
+        for (const QString& key : embeddingModelKeys(ModelPrecision::Float32)) {
+            ModelRegistry::instance().releaseIfIdle(key);
+        }
+    }
+    if (!referenceEmbedding.defined()) {
+        return std::nan("");
+    }
+
+    torch::Tensor candidateEmbedding;
+    if (ensureEmbeddingModelLoaded(precision)) {
+        candidateEmbedding = embeddingModel->processBatch(clip);
+    }
+    if (!candidateEmbedding.defined()) {
+        return -1.0;
+    }
+
+    const double cosine = torch::cosine_similarity(referenceEmbedding, candidateEmbedding, 1).item<double>();
+    qDebug() << "SeparationWorker:" << precisionName(precision) << "HTSAT embedding cosine vs float32" << cosine;
+    return cosine;
+}
+
+/**
+ * @brief Accuracy gate for bf16: runs the reference chunk in both precisions once per session.
+ *
+ * The separated waveform must reach BF16_MIN_SNR_DB against float32 and, when the
+ * job uses the HTSAT pre-pass, the embedding BF16_MIN_EMBEDDING_COSINE.
+ * A failed check refuses the precision for the rest of the session; a check that
+ * could not run (unreadable reference file) only falls back for this job.
+ * Other reduced precisions are measured and reported but not gated.
+ *
+ * @return True if the job may use options.precision.
+ */
+bool SeparationWorker::verifyPrecision(const QString& audioPath, const torch::Tensor& condition,
+                                       const SeparationOptions& options)
+{
+    const ModelPrecision precision = options.precision;
+    if (precision == ModelPrecision::Float32) {
+        return true;
+    }
+    if (refusedPrecisions.count(precision)) {
+        return false;
+    }
+    const bool gated = precision == ModelPrecision::BFloat16;
+
+    if (!comparedPrecisions.count(precision)) {
+        const bool referenceWasLoaded = extractor->isModelLoaded();
+        if (!ensureModelLoaded(ModelPrecision::Float32)) {
+            return !gated;
+        }
+        const double snrDb = comparePrecision(audioPath, condition, precision);
+        // Only the model the job runs on stays loaded: a float32 model loaded just
+        // for the comparison goes as soon as the reduced precision is accepted
+        const bool accepted = std::isnan(snrDb) ? !gated : !(gated && snrDb < Constants::BF16_MIN_SNR_DB);
+        if (accepted && !referenceWasLoaded) {
+            unloadExtractor(extractor);
+        }
+        if (std::isnan(snrDb)) {
+            return !gated;
+        }
+        comparedPrecisions.insert(precision);
+        if (gated && snrDb < Constants::BF16_MIN_SNR_DB) {
+            refusedPrecisions.insert(precision);
+            emit precisionRefused(precisionName(precision),
+                                  QString("separated-output SNR %1 dB is below %2 dB")
+                                  .arg(snrDb, 0, 'f', 1).arg(Constants::BF16_MIN_SNR_DB, 0, 'f', 1));
+            return false;
+        }
+    }
+
+    // The embedding check only matters if the gate will run HTSAT in this precision
+    if (gated && options.similarityGate && gateEmbeddingPrecision(precision) == precision
+        && !verifiedEmbeddingPrecisions.count(precision)) {
+        const double cosine = compareEmbeddingPrecision(audioPath, precision);
+        if (std::isnan(cosine)) {
+            return false;
+        }
+        if (cosine < Constants::BF16_MIN_EMBEDDING_COSINE) {
+            refusedPrecisions.insert(precision);
+            emit precisionRefused(precisionName(precision),
+                                  QString("HTSAT embedding cosine %1 is below %2")
+                                  .arg(cosine, 0, 'f', 4).arg(Constants::BF16_MIN_EMBEDDING_COSINE, 0, 'f', 4));
+            return false;
         }
-        values.push_back(val);
+        verifiedEmbeddingPrecisions.insert(precision);
     }
+    return true;
+}
+
+bool SeparationWorker::isModelLoaded() const
+{
+    return extractor->isModelLoaded();
+}
+
+void SeparationWorker::preloadModel()
+{
+    ensureModelLoaded();
+}
 
-    if (values.empty()) {
-        emit error("Feature file is empty or invalid format");
+void SeparationWorker::warmUp()
+{
+    ThreadBudget::JobLease lease("separation warm-up");
+    bool ok = ensureModelLoaded();
+    if (ok) {
+        ok = extractor->forward(torch::zeros({1, clipSamples, 1}), torch::zeros({1, 2048})).defined();
+    }
+    qDebug() << "SeparationWorker: warm-up" << (ok ? "finished" : "failed");
+    emit warmedUp(ok);
+}
+
+void SeparationWorker::releaseModel()
+{
+    // Only this worker's models are freed; a warm HTSAT held for feature jobs stays
+    const bool wasLoaded = unloadExtractor(extractor);
+    if (wasLoaded) {
+        qDebug() << "SeparationWorker: ZeroShotASP model released";
+    }
+    for (auto& variant : variantExtractors) {
+        if (unloadExtractor(variant.second)) {
+            qDebug() << "SeparationWorker: ZeroShotASP variant model released";
+        }
+    }
+    if (embeddingModel) {
+        const QString key = embeddingModel->registryKey();
+        delete embeddingModel;
+        embeddingModel = nullptr;
+        ModelRegistry::instance().releaseIfIdle(key);
+        qDebug() << "SeparationWorker: HTSAT model released";
+    }
+    if (wasLoaded) {
+        emit modelReleased();
+    }
+}
+
+torch::Tensor SeparationWorker::loadFeature(const QString& featurePath)
+{
+    // Binary features are read in one go; legacy .txt features are parsed
+    QString errorMessage;
+    FeatureFileInfo info;
+    torch::Tensor tensor = FeatureStore::loadFeatureTensor(featurePath, &errorMessage, &info);
+    if (!tensor.defined()) {
+        emit error(errorMessage);
+        return torch::Tensor();
+    }
+
+    // A query is one HTSAT embedding, the separation model's condition size
+    const QString featureName = QFileInfo(featurePath).completeBaseName();
+    if (info.rows != 1 || info.dimension != Constants::EMBEDDING_DIM) {
+        emit error(QString("%1 holds a %2 x %3 feature; separation needs 1 x %4")
+                       .arg(featureName).arg(info.rows).arg(info.dimension).arg(Constants::EMBEDDING_DIM));
         return torch::Tensor();
     }
 
-    torch::Tensor tensor = torch::from_blob(values.data(), {(int64_t)values.size()}, torch::kFloat).clone();
-    tensor = tensor.unsqueeze(0);  // Reshape to (1, feature_size)
-    return tensor;
+    // Features are embedded by the float32 HTSAT that HTSATWorker loads, resource first.
+    // Legacy features carry no version and are taken as they are.
+    if (!info.modelVersion.isEmpty()) {
+        const QString source = QResource(Constants::HTSAT_MODEL_RESOURCE).isValid() ? Constants::HTSAT_MODEL_RESOURCE
+                                                                                     : Constants::HTSAT_MODEL_PATH;
+        const bool reference = InferenceBackends::kind() == InferenceBackends::Kind::Reference;
+        if (info.modelVersion != HTSATProcessor::modelVersionFor(source, torch::kFloat, reference)) {
+            emit error(QString("%1 was built with a different embedding model; create it again").arg(featureName));
+            return torch::Tensor();
+        }
+    }
+    return tensor;  // (1, feature_size)
+}
+
+QString SeparationWorker::resultPathFor(const QString& audioPath, const QString& featureName)
+{
+    QString outputName = QFileInfo(audioPath).baseName() + "_" + featureName + "_separated.wav";
+    return Constants::SEPARATED_RESULT_DIR + "/" + outputName;
 }
 
 torch::Tensor SeparationWorker::processChunk(const torch::Tensor& waveform,
@@ -65,12 +486,12 @@ torch::Tensor SeparationWorker::processChunk(const torch::Tensor& waveform,
         return torch::Tensor();
     }
 
-    if (waveform.dim() != 3 || waveform.size(0) != 1 || waveform.size(2) != 1 || waveform.size(1) != clipSamples) {
+    if (waveform.dim() != 3 || waveform.size(0) < 1 || waveform.size(2) != 1 || waveform.size(1) != clipSamples) {
         emit error("Invalid waveform shape for processChunk");
         return torch::Tensor();
     }
 
-    if (condition.dim() != 2 || condition.size(0) != 1) {
+    if (condition.dim() != 2 || (condition.size(0) != 1 && condition.size(0) != waveform.size(0))) {
         emit error("Invalid condition shape for processChunk");
         return torch::Tensor();
     }
@@ -84,198 +505,859 @@ torch::Tensor SeparationWorker::processChunk(const torch::Tensor& waveform,
     }
 }
 
-torch::Tensor SeparationWorker::doOverlapAdd(const std::vector<torch::Tensor>& chunks)
+torch::Tensor SeparationWorker::separateBatch(const torch::Tensor& batch, const torch::Tensor& conditions,
+                                              const SeparationOptions& options, int64_t* skippedChunks,
+                                              const torch::Tensor& keepMask)
 {
-    if (chunks.empty()) {
-        emit error("No chunks to overlap-add");
-        return torch::Tensor();
+    const int64_t numWindows = batch.size(0);
+    const int64_t numFeatures = conditions.size(0);
+
+    // Windows under the noise floor, or far from anything query-like, never reach the model
+    torch::Tensor silent = AudioPreprocessUtils::silentChunkMask(
+        batch.squeeze(2), options.silenceRmsThreshold, options.silencePeakThreshold);
+    torch::Tensor active = silent.logical_not();
+    if (keepMask.defined()) {
+        active = active.logical_and(keepMask);
+    }
+    torch::Tensor activeIndices = torch::nonzero(active).flatten();
+    const int64_t numActive = activeIndices.size(0);
+    if (skippedChunks) {
+        *skippedChunks += numWindows - numActive;
     }
 
-    try {
-        int64_t chunkSize = chunks[0].size(1);
-        int64_t step = static_cast<int64_t>(chunkSize * (1.0f - overlapRate));
-        int64_t totalLength = step * (chunks.size() - 1) + chunkSize;
+    ZeroShotASPFeatureExtractor* model = extractorFor(options.precision);
+    if (numActive == numWindows) {
+        return runSeparation(batch, conditions, model);
+    }
+
+    // Skipped windows still go through the overlap-add so the crossfades stay intact;
+    // only silent windows may pass through, dissimilar ones hold no target sound
+    torch::Tensor output = torch::zeros({numWindows, numFeatures, batch.size(1), batch.size(2)}, torch::kFloat);
+    if (options.silenceFill == SilenceFill::Passthrough) {
+        torch::Tensor silentIndices = torch::nonzero(silent).flatten();
+        output.index_copy_(0, silentIndices, batch.index_select(0, silentIndices).unsqueeze(1)
+            .expand({silentIndices.size(0), numFeatures, batch.size(1), batch.size(2)}).to(torch::kFloat));
+    }
+    if (numActive == 0) {
+        return output;
+    }
 
-        torch::Tensor output = torch::zeros({1, totalLength, 1}, torch::kFloat);
-        torch::Tensor weight = torch::zeros({totalLength}, torch::kFloat);
+    torch::Tensor separated = runSeparation(batch.index_select(0, activeIndices), conditions, model);
+    if (!separated.defined()) {
+        return torch::Tensor();
+    }
+    output.index_copy_(0, activeIndices, separated.to(output.dtype()));
+    return output;
+}
 
-        for (size_t i = 0; i < chunks.size(); ++i) {
-            const torch::Tensor& chunk = chunks[i];
-            int64_t start = i * step;
-            int64_t end = start + chunkSize;
+torch::Tensor SeparationWorker::runSeparation(const torch::Tensor& batch, const torch::Tensor& conditions,
+                                              ZeroShotASPFeatureExtractor* model)
+{
+    const int64_t numFeatures = conditions.size(0);
 
-            if (chunk.size(1) != chunkSize) {
-                emit error("Chunk size mismatch in doOverlapAdd");
+    // Without encode/decode every query costs a full forward anyway; running them
+    // one at a time keeps each forward at the job's batch size instead of W x F rows
+    if (numFeatures == 1 || !model->hasSplitInference()) {
+        std::vector<torch::Tensor> outputs;
+        outputs.reserve(numFeatures);
+        for (int64_t f = 0; f < numFeatures; ++f) {
+            torch::Tensor output = processChunk(batch, conditions.slice(0, f, f + 1), model);
+            if (!output.defined() || output.numel() == 0) {
                 return torch::Tensor();
             }
+            outputs.push_back(output);
+        }
+        return torch::stack(outputs, 1);
+    }
 
-             // Overlap-add with linear ramp weights
-            torch::Tensor window = torch::ones({chunkSize}, torch::kFloat);
-            int64_t fadeLength = static_cast<int64_t>(chunkSize * overlapRate);
-            if (fadeLength > 0) {
-                torch::Tensor fadeIn = torch::linspace(0, 1, fadeLength);
-                torch::Tensor fadeOut = torch::linspace(1, 0, fadeLength);
-                window.slice(0, 0, fadeLength) = fadeIn;
-                window.slice(0, chunkSize - fadeLength, chunkSize) = fadeOut;
-            }
+    // Models with encode/decode encode each chunk once and decode it per query
+    try {
+        torch::Tensor output = model->separate(batch, conditions);
+        return output.defined() && output.numel() > 0 ? output : torch::Tensor();
+    } catch (const c10::Error& e) {
+        emit error(QString("Extractor separate error: %1").arg(e.what()));
+        return torch::Tensor();
+    }
+}
 
-            // Get the target slice from output tensor
-            torch::Tensor outputSlice = output.slice(1, start, end);  // Shape: [1, chunkSize, 1]
-            torch::Tensor chunkSlice = chunk.slice(1, 0, chunkSize);  // Shape: [1, chunkSize, 1]
-            
-            // Apply windowing to chunk
-            torch::Tensor windowedChunk = chunkSlice * window.unsqueeze(0).unsqueeze(2);  // Shape: [1, chunkSize, 1]
-            
-            // Add to output slice
-            outputSlice.add_(windowedChunk);
-            
-            // Update weight
-            weight.slice(0, start, end).add_(window);
+torch::Tensor SeparationWorker::similarChunkMask(const torch::Tensor& samples, int64_t offset, int64_t numChunks,
+                                                int64_t step, const torch::Tensor& conditions,
+                                                const SeparationOptions& options)
+{
+    // Probe with non-overlapping clips: half as many HTSAT forwards as separation windows,
+    // and HTSAT alone is far cheaper than the separation U-Net
+    const int64_t numProbes = std::max<int64_t>(1, (samples.size(0) + clipSamples - 1) / clipSamples);
+    torch::Tensor probes = torch::constant_pad_nd(samples, {0, numProbes * clipSamples - samples.size(0)}, 0)
+        .view({numProbes, clipSamples});
+
+    const int64_t probeBatch = std::max(1, options.batchSize);
+    std::vector<torch::Tensor> embeddings;
+    for (int64_t first = 0; first < numProbes; first += probeBatch) {
+        if (!control.checkpoint()) {
+            return torch::Tensor();
+        }
+        torch::Tensor embedding = embeddingModel->processBatch(probes.slice(0, first, std::min(first + probeBatch, numProbes)));
+        if (!embedding.defined()) {
+            qDebug() << "SeparationWorker: similarity pre-pass failed, separating every chunk";
+            return torch::Tensor();
         }
+        embeddings.push_back(embedding);
+    }
 
-        // Normalize by weight to avoid amplitude scaling
-        weight = torch::where(weight == 0, torch::ones_like(weight), weight);
-        // Reshape weight to match output tensor dimensions for broadcasting
-        weight = weight.unsqueeze(0).unsqueeze(2);  // Shape: [totalLength] -> [1, totalLength, 1]
-        output = output / weight;
+    // Best cosine similarity of each probe to any query feature
+    torch::Tensor probeEmbeddings = torch::nn::functional::normalize(torch::cat(embeddings, 0),
+        torch::nn::functional::NormalizeFuncOptions().dim(1));
+    torch::Tensor queries = torch::nn::functional::normalize(conditions.to(torch::kFloat),
+        torch::nn::functional::NormalizeFuncOptions().dim(1));
+    torch::Tensor similar = probeEmbeddings.matmul(queries.t()).amax(1) >= options.similarityThreshold;
 
-        // Output is already (1, totalLength, 1), no reshape needed
+    // A target sound straddling a probe boundary keeps its neighbours alive too
+    const int64_t radius = std::max(0, options.similarityNeighbourhood);
+    if (radius > 0) {
+        similar = torch::max_pool1d(similar.to(torch::kFloat).view({1, 1, numProbes}), {2 * radius + 1}, {1}, {radius})
+            .view({numProbes}) > 0;
+    }
 
-        return output;
+    // A separation window spans at most two probes; keep it if either is similar
+    torch::Tensor starts = torch::arange(numChunks, torch::kLong) * step + offset;
+    torch::Tensor firstProbe = starts.div(clipSamples, "floor").clamp_max(numProbes - 1);
+    torch::Tensor lastProbe = (starts + clipSamples - 1).div(clipSamples, "floor").clamp_max(numProbes - 1);
+    return similar.index_select(0, firstProbe).logical_or(similar.index_select(0, lastProbe));
+}
+
+int64_t SeparationWorker::windowsPerBatch(const SeparationOptions& options, int64_t numFeatures) const
+{
+    // batchSize counts forward rows, so more features means fewer windows per call
+    return std::max<int64_t>(1, std::max(1, options.batchSize) / std::max<int64_t>(1, numFeatures));
+}
+
+int64_t SeparationWorker::stepFor(const SeparationOptions& options) const
+{
+    return static_cast<int64_t>(clipSamples * (1.0f - options.overlapRate));
+}
+
+void SeparationWorker::dumpSeparatedChunks(const QStringList& featureNames, int64_t firstChunk,
+                                           const torch::Tensor& separated)
+{
+    for (int f = 0; f < featureNames.size(); ++f) {
+        for (int64_t i = 0; i < separated.size(0); ++i) {
+            QString chunkFilePath = QString("%1/%2_chunk_%3.wav").arg(Constants::TEMP_SEGMENTS_DIR).arg(featureNames[f]).arg(firstChunk + i);
+            emit chunkReady(chunkFilePath, featureNames[f], separated.select(1, f).slice(0, i, i + 1));
+        }
+    }
+}
+
+torch::Tensor SeparationWorker::doOverlapAdd(const std::vector<torch::Tensor>& chunks)
+{
+    if (chunks.empty()) {
+        emit error("No chunks to overlap-add");
+        return torch::Tensor();
+    }
+
+    int64_t chunkSize = chunks[0].size(1);
+    for (const torch::Tensor& chunk : chunks) {
+        if (chunk.size(1) != chunkSize) {
+            emit error("Chunk size mismatch in doOverlapAdd");
+            return torch::Tensor();
+        }
+    }
+
+    try {
+        // Each chunk is (1, chunkSize, 1); stack them into (N, chunkSize, 1)
+        return doOverlapAdd(torch::cat(chunks, 0));
     } catch (const c10::Error& e) {
         emit error(QString("Overlap-add error: %1").arg(e.what()));
         return torch::Tensor();
     }
 }
 
-torch::Tensor SeparationWorker::doOverlapAdd(const QStringList& chunkFilePaths)
+torch::Tensor SeparationWorker::doOverlapAdd(const torch::Tensor& chunks)
 {
-    std::vector<torch::Tensor> chunks;
-    for (const QString& path : chunkFilePaths) {
-    torch::Tensor chunk = AudioPreprocessUtils::loadAudio(path); // 1D (frames,)
-    if (chunk.numel() == 0) {
-        emit error(QString("Failed to load chunk from: %1").arg(path));
+    if (!chunks.defined() || chunks.dim() != 3 || chunks.size(0) == 0 || chunks.size(2) != 1) {
+        emit error("No chunks to overlap-add");
         return torch::Tensor();
     }
 
-    // Apply Hann window directly
-    chunk = AudioPreprocessUtils::applyHannWindow(chunk); // still 1D
+    try {
+        int64_t numChunks = chunks.size(0);
+        int64_t chunkSize = chunks.size(1);
+        int64_t step = static_cast<int64_t>(chunkSize * (1.0f - overlapRate));
+        int64_t totalLength = step * (numChunks - 1) + chunkSize;
 
-    // reshape to (1, frames, 1) for model
-    chunk = chunk.unsqueeze(0).unsqueeze(2);
+        OverlapAddBuffer buffer(chunkSize, step, overlapRate, totalLength);
+        if (!buffer.addChunks(0, chunks)) {
+            emit error("Chunk size mismatch in doOverlapAdd");
+            return torch::Tensor();
+        }
+        return buffer.finish(totalLength).view({1, totalLength, 1});
+    } catch (const c10::Error& e) {
+        emit error(QString("Overlap-add error: %1").arg(e.what()));
+        return torch::Tensor();
+    }
+}
 
-    chunks.push_back(chunk);
+void SeparationWorker::processFile(const QStringList& filePaths, const QStringList& featureNames,
+                                   const SeparationOptions& options)
+{
+    // This job's share of the cores, split between the scheduler threads; returned
+    // before jobEnded so the next job is sized without it
+    processedSamples = 0;
+    {
+        ThreadBudget::JobLease lease("separation");
+        leasedCores = lease.cores();
+        separateFiles(filePaths, featureNames, options);
+    }
+
+    // Realtime factor of a completed job: wall time from the models being ready
+    // over the audio it separated, so loads and precision checks are not counted
+    const double audioSeconds = static_cast<double>(processedSamples) / Constants::AUDIO_SAMPLE_RATE;
+    if (!control.isStopped() && audioSeconds > 0.0) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - inferenceStart;
+        const QString precision = precisionName(jobPrecision);
+        qDebug() << "SeparationWorker: tier" << options.tier << precision << "realtime factor" << elapsed.count() / audioSeconds;
+        emit realtimeFactorMeasured(options.tier, precision, elapsed.count() / audioSeconds);
     }
-    return doOverlapAdd(chunks);
+
+    // A cancelled job gives its memory back right away; a preempted one keeps
+    // the model for the job that displaced it
+    const JobControl::StopReason stopReason = control.stopReason();
+    if (stopReason == JobControl::StopReason::Cancelled) {
+        releaseModel();
+    }
+    emit jobEnded(stopReason != JobControl::StopReason::None);
 }
 
-void SeparationWorker::processFile(const QStringList& filePaths, const QString& featureName)
+void SeparationWorker::separateFiles(const QStringList& filePaths, const QStringList& featureNames,
+                                     const SeparationOptions& options)
 {
+    if (featureNames.isEmpty()) {
+        emit error("No sound feature selected for separation");
+        return;
+    }
+
+    // Load once up front; the model then stays resident for every file and later jobs.
+    // A missing or refused reduced-precision variant falls back to the float32 model.
+    SeparationOptions jobOptions = options;
+    jobOptions.overlapRate = std::clamp(jobOptions.overlapRate, 0.0f, 0.9f);
+    if (jobOptions.precision != ModelPrecision::Float32
+        && (refusedPrecisions.count(jobOptions.precision) || !ensureModelLoaded(jobOptions.precision))) {
+        qDebug() << "SeparationWorker: falling back to float32 models";
+        jobOptions.precision = ModelPrecision::Float32;
+    }
+
+    // Load every query feature once and stack them into (numFeatures, 2048)
+    std::vector<torch::Tensor> conditionList;
+    for (const QString& featureName : featureNames) {
+        QString featurePath = FeatureStore::featurePathFor(featureName);
+        torch::Tensor condition = loadFeature(featurePath);
+        if (!condition.defined() || condition.numel() == 0) {
+            emit error(QString("Failed to load feature tensor: %1").arg(featurePath));
+            return;
+        }
+        conditionList.push_back(condition);
+    }
+    torch::Tensor conditions = torch::cat(conditionList, 0);
+
+    // Measure a reduced precision against float32 the first time it is used; bf16 must also pass
+    if (!filePaths.isEmpty() && !verifyPrecision(filePaths.first(), conditions.slice(0, 0, 1), jobOptions)) {
+        qDebug() << "SeparationWorker:" << precisionName(jobOptions.precision) << "failed its accuracy check, using float32";
+        unloadExtractor(extractorFor(jobOptions.precision));
+        jobOptions.precision = ModelPrecision::Float32;
+    }
+    if (!ensureModelLoaded(jobOptions.precision)) {
+        return;
+    }
+
+    if (jobOptions.similarityGate && !ensureEmbeddingModelLoaded(gateEmbeddingPrecision(jobOptions.precision))
+        && !ensureEmbeddingModelLoaded(ModelPrecision::Float32)) {
+        qDebug() << "SeparationWorker: HTSAT model unavailable, similarity gating disabled";
+        jobOptions.similarityGate = false;
+    }
+    inferenceStart = std::chrono::steady_clock::now();
+    jobPrecision = jobOptions.precision;
+
+    // Files are spread over the work-stealing pool when more than one thread is
+    // available, or pipelined decode -> inference -> write on a single inference
+    // thread. The decode stage leaves long recordings undecoded; they go to the
+    // bounded-memory streaming path afterwards.
+    QStringList longFiles;
+
+    // Stage 3: results are written on their own thread, never on the GUI thread
+    BoundedQueue<SeparatedResult> writeQueue(Constants::PIPELINE_QUEUE_DEPTH);
+    std::thread writer([this, &writeQueue]() {
+        ThreadBudget::enterDspThread();
+        writeResults(writeQueue);
+    });
+
+    if (resolveWorkerThreads(jobOptions) > 1) {
+        processFilesScheduled(filePaths, featureNames, conditions, jobOptions, writeQueue, longFiles);
+    } else {
+        processFilesPipelined(filePaths, featureNames, conditions, jobOptions, writeQueue, longFiles);
+    }
+    writeQueue.close();
+
+    // Streamed files write their own output while the last results drain, in input order.
+    // A path listed more than once is streamed once; the long files take the last
+    // progress slots so the job total never moves backwards
+    QStringList streamFiles;
     for (const QString& audioPath : filePaths) {
-        processSingleFile(audioPath, featureName);
+        if (longFiles.contains(audioPath) && !streamFiles.contains(audioPath)) {
+            streamFiles.append(audioPath);
+        }
+    }
+    const int fileCount = filePaths.size();
+    for (int i = 0; i < streamFiles.size(); ++i) {
+        if (control.isStopped()) {
+            break;
+        }
+        processSingleFileStreaming(streamFiles[i], featureNames, conditions, jobOptions,
+                                   fileCount - streamFiles.size() + i, fileCount);
+    }
+
+    writer.join();
+    if (!control.isStopped()) {
+        emit progressUpdated(100);
     }
 }
 
-void SeparationWorker::processSingleFile(const QString& audioPath, const QString& featureName)
+JobControl* SeparationWorker::jobControl()
 {
-    ZeroShotASPFeatureExtractor extractor;
-    if (!extractor.loadModelFromResource(Constants::ZERO_SHOT_ASP_MODEL_RESOURCE)) {
-        qDebug() << "Failed to load ZeroShotASP model from resource, trying absolute path...";
-        if (!extractor.loadModel(Constants::ZERO_SHOT_ASP_MODEL_PATH)) {
-            emit error("Failed to load separation model");
-            return;
+    return &control;
+}
+
+void SeparationWorker::writeResults(BoundedQueue<SeparatedResult>& queue)
+{
+    SeparatedResult result;
+    while (queue.pop(result)) {
+        if (control.stopReason() == JobControl::StopReason::Cancelled) {
+            result = SeparatedResult();
+            continue;
+        }
+        for (int f = 0; f < result.featureNames.size(); ++f) {
+            QString outputPath = resultPathFor(result.audioPath, result.featureNames[f]);
+            AudioStreamWriter writer;
+            if (!writer.open(outputPath, Constants::AUDIO_SAMPLE_RATE) || !writer.write(result.outputs[f])) {
+                emit error(QString("Failed to write output file: %1").arg(outputPath));
+                continue;
+            }
+            writer.close();
+            emit separationWritten(result.audioPath, result.featureNames[f], outputPath);
+        }
+        if (!result.outputs.empty()) {
+            processedSamples += result.outputs[0].numel();
         }
+        result = SeparatedResult();
     }
+}
 
+torch::Tensor SeparationWorker::decodeInput(const QString& audioPath, const SeparationOptions& options, bool* tooLong)
+{
     QFileInfo audioFileInfo(audioPath);
     if (!audioFileInfo.exists() || !audioFileInfo.isReadable()) {
         emit error(QString("Audio file does not exist or is not readable: %1").arg(audioPath));
-        return;
+        return torch::Tensor();
     }
 
-    // Load feature tensor
-    QString featurePath = QString("%1/%2.txt").arg(Constants::OUTPUT_FEATURES_DIR).arg(featureName);
-    torch::Tensor condition = loadFeature(featurePath);
-    if (!condition.defined() || condition.numel() == 0) {
-        emit error(QString("Failed to load feature tensor: %1").arg(featurePath));
-        return;
+    // Load audio waveform tensor from file (decoded, downmixed and resampled to 32kHz);
+    // the same open reports whether the file is too long to hold in memory
+    bool overThreshold = false;
+    const double maxSeconds = tooLong ? options.streamingThresholdSeconds : -1.0;
+    torch::Tensor waveform = AudioPreprocessUtils::loadAudio(audioPath, maxSeconds, &overThreshold);
+    if (overThreshold) {
+        *tooLong = true;
+        return torch::Tensor();
     }
-
-    // Load audio waveform tensor from file (assumed to be WAV)
-    torch::Tensor waveform = AudioPreprocessUtils::loadAudio(audioPath);
-    if (waveform.numel() == 0) {
+    if (waveform.numel() == 0 || waveform.dim() != 1) {
         emit error(QString("Failed to load audio waveform from: %1").arg(audioPath));
-        return;
+        return torch::Tensor();
     }
 
-    AudioPreprocessUtils::saveToWav(waveform, Constants::TEMP_SEGMENTS_DIR + "/mono.wav");
+    if (options.dumpChunks) {
+        AudioPreprocessUtils::saveToWav(waveform, Constants::TEMP_SEGMENTS_DIR + "/mono.wav");
+    }
+    return waveform;
+}
 
-    if (waveform.dim() != 1) {
-        emit error("Loaded waveform tensor must be 1D");
-        return;
+void SeparationWorker::processFilesPipelined(const QStringList& filePaths, const QStringList& featureNames,
+                                             const torch::Tensor& conditions, const SeparationOptions& options,
+                                             BoundedQueue<SeparatedResult>& writeQueue, QStringList& longFiles)
+{
+    // Stage 1: decode and resample the next files while the model works on the current one.
+    // longFiles is only touched by the decoder until it is joined
+    BoundedQueue<DecodedAudio> decodeQueue(Constants::PIPELINE_QUEUE_DEPTH);
+    std::thread decoder([this, &filePaths, &options, &decodeQueue, &longFiles]() {
+        ThreadBudget::enterDspThread();
+        for (int index = 0; index < filePaths.size(); ++index) {
+            if (!control.checkpoint()) {
+                break;
+            }
+            const QString& audioPath = filePaths[index];
+            DecodedAudio decoded;
+            decoded.audioPath = audioPath;
+            bool tooLong = false;
+            decoded.waveform = decodeInput(audioPath, options, &tooLong);
+            if (tooLong) {
+                longFiles.append(audioPath);
+                continue;
+            }
+            if (decoded.waveform.defined() && !decodeQueue.push(std::move(decoded))) {
+                break;
+            }
+        }
+        decodeQueue.close();
+    });
+
+    // Stage 2: inference on this thread; finished files move on to the write stage.
+    // Progress counts files in the order they arrive, ahead of the streamed long files
+    DecodedAudio decoded;
+    int fileIndex = 0;
+    while (decodeQueue.pop(decoded)) {
+        SeparatedResult result;
+        result.audioPath = decoded.audioPath;
+        result.featureNames = featureNames;
+        if (separateWaveform(decoded.audioPath, decoded.waveform, featureNames, conditions, options,
+                             fileIndex++, filePaths.size(), result.outputs)) {
+            writeQueue.push(std::move(result));
+        }
+        decoded = DecodedAudio();
     }
 
+    decoder.join();
+}
+
+bool SeparationWorker::separateWaveform(const QString& audioPath, const torch::Tensor& waveform,
+                                        const QStringList& featureNames, const torch::Tensor& conditions,
+                                        const SeparationOptions& options, int fileIndex, int fileCount,
+                                        std::vector<torch::Tensor>& outputs)
+{
     int64_t totalSamples = waveform.size(0);
-    int64_t step = static_cast<int64_t>(clipSamples * (1.0f - overlapRate));
+    int64_t step = stepFor(options);
     if (step <= 0) {
         emit error("Invalid step size calculated from clipSamples and overlapRate");
-        return;
+        return false;
     }
 
-    int64_t pos = 0;
-    int chunkIndex = 0;
-    QStringList chunkFilePaths;
+    const int64_t numFeatures = conditions.size(0);
+    const int64_t batchSize = windowsPerBatch(options, numFeatures);
+
+    // One window starts every `step` samples until the end of the file; pad the
+    // tail with zeros so the last window is full length, then view all windows
+    // as (numChunks, clipSamples) without copying.
+    const int64_t numChunks = (totalSamples + step - 1) / step;
+    const int64_t paddedLength = step * (numChunks - 1) + clipSamples;
+    torch::Tensor padded = torch::constant_pad_nd(waveform, {0, paddedLength - totalSamples}, 0);
+    torch::Tensor windows = padded.unfold(0, clipSamples, step);
+    torch::Tensor keepMask = options.similarityGate
+        ? similarChunkMask(padded, 0, numChunks, step, conditions, options)
+        : torch::Tensor();
 
-    while (pos < totalSamples) {
-        int64_t endPos = pos + clipSamples;
-        torch::Tensor chunk;
-        if (endPos <= totalSamples) {
-            chunk = waveform.slice(0, pos, endPos);
-        } else {
-            // Pad last chunk with zeros if needed
-            int64_t padSize = endPos - totalSamples;
-            torch::Tensor tail = waveform.slice(0, pos, totalSamples);
-            torch::Tensor padding = torch::zeros({padSize}, torch::kFloat);
-            chunk = torch::cat({tail, padding}, 0);
+    // Separated chunks are overlap-added in memory as soon as they leave the model,
+    // one output buffer per requested feature
+    std::vector<std::unique_ptr<OverlapAddBuffer>> buffers;
+    for (int64_t f = 0; f < numFeatures; ++f) {
+        buffers.push_back(std::make_unique<OverlapAddBuffer>(clipSamples, step, options.overlapRate, paddedLength));
+    }
+
+    int64_t skippedChunks = 0;
+    for (int64_t first = 0; first < numChunks; first += batchSize) {
+        if (!control.checkpoint()) {
+            return false;
         }
+        ThreadBudget::instance().applyJobShare();
+        int64_t last = std::min(first + batchSize, numChunks);
 
-        // Reshape chunk to (1, clipSamples, 1)
-        chunk = chunk.unsqueeze(0).unsqueeze(2);
+        // Stack N windows into (N, clipSamples, 1) and run a single forward for all features
+        torch::Tensor batch = windows.slice(0, first, last).unsqueeze(2).contiguous();
 
-        torch::Tensor processedChunk = processChunk(chunk, condition, &extractor);
-        if (!processedChunk.defined() || processedChunk.numel() == 0) {
+        torch::Tensor separated = separateBatch(batch, conditions, options, &skippedChunks,
+                                                keepMask.defined() ? keepMask.slice(0, first, last) : torch::Tensor());
+        if (!separated.defined()) {
             emit error("Processing chunk failed");
-            return;
+            return false;
         }
 
-        // Save chunk to file immediately, do not store in RAM vector
-        QString chunkFilePath = QString("%1/%2_chunk_%3.wav").arg(Constants::TEMP_SEGMENTS_DIR).arg(featureName).arg(chunkIndex);
-        emit chunkReady(chunkFilePath, featureName, processedChunk);
-        chunkFilePaths.append(chunkFilePath);
+        for (int64_t f = 0; f < numFeatures; ++f) {
+            if (!buffers[f]->addChunks(first, separated.select(1, f))) {
+                emit error("Overlap-add failed");
+                return false;
+            }
+        }
 
-        // Update progress
-        int progress = static_cast<int>(100.0 * (pos + clipSamples) / totalSamples);
-        if (progress > 100) progress = 100;
-        emit progressUpdated(progress);
+        if (options.dumpChunks) {
+            dumpSeparatedChunks(featureNames, first, separated);
+        }
 
-        pos += step;
-        chunkIndex++;
+        // Update progress across the whole job
+        int progress = static_cast<int>(100.0 * (fileIndex + static_cast<double>(last) / numChunks) / fileCount);
+        emit progressUpdated(std::min(progress, 99));
     }
 
-    // Unload model to free memory before overlap-add
-    extractor.unloadModel();
+    emit chunksSkipped(audioPath, skippedChunks, numChunks);
 
-    // Load chunk files and do overlap-add incrementally
     try {
-        torch::Tensor finalTensor = doOverlapAdd(chunkFilePaths);
-        if (!finalTensor.defined() || finalTensor.numel() == 0) {
-            emit error("Overlap-add failed");
-            return;
+        for (int64_t f = 0; f < numFeatures; ++f) {
+            // Drop the zero padding so the result matches the input length
+            torch::Tensor finalTensor = buffers[f]->finish(totalSamples);
+            if (!finalTensor.defined() || finalTensor.numel() == 0) {
+                emit error("Overlap-add failed");
+                return false;
+            }
+            outputs.push_back(finalTensor);
         }
-
-        emit separationFinished(audioPath, featureName, finalTensor);
     } catch (const c10::Error& e) {
         emit error(QString("Final overlap-add error: %1").arg(e.what()));
+        return false;
+    }
+    return true;
+}
+
+void SeparationWorker::processSingleFileStreaming(const QString& audioPath, const QStringList& featureNames,
+                                                  const torch::Tensor& conditions, const SeparationOptions& options,
+                                                  int fileIndex, int fileCount)
+{
+    int64_t step = stepFor(options);
+    if (step <= 0) {
+        emit error("Invalid step size calculated from clipSamples and overlapRate");
+        return;
+    }
+
+    // Long recordings are decoded, separated and written one window at a time
+    AudioStreamReader reader(Constants::AUDIO_SAMPLE_RATE);
+    if (!reader.open(audioPath)) {
+        emit error(QString("Failed to load audio waveform from: %1").arg(audioPath));
         return;
     }
+
+    qDebug() << "SeparationWorker: streaming" << audioPath << "(" << reader.durationSeconds() << "s )";
+
+    const int64_t numFeatures = conditions.size(0);
+    const int64_t batchSize = windowsPerBatch(options, numFeatures);
+    const int64_t span = step * (batchSize - 1) + clipSamples; // Samples covered by one full batch
+    // The similarity pre-pass also looks this far past both ends of a batch, so
+    // chunks at batch edges see the same neighbourhood as anywhere else
+    const int64_t gateContext = options.similarityGate
+        ? static_cast<int64_t>(std::max(0, options.similarityNeighbourhood)) * clipSamples : 0;
+    const int64_t estimatedChunks = std::max<int64_t>(1, (reader.estimatedTotalSamples() + step - 1) / step);
+
+    // One output file and one overlap buffer per feature; only the current batch
+    // span and the still-open overlap region are resident
+    QStringList outputPaths;
+    std::vector<std::unique_ptr<AudioStreamWriter>> writers;
+    std::vector<std::unique_ptr<OverlapAddBuffer>> buffers;
+
+    auto discard = [&]() {
+        for (int f = 0; f < static_cast<int>(writers.size()); ++f) {
+            writers[f]->close();
+            QFile::remove(outputPaths[f]);
+        }
+    };
+    auto fail = [&](const QString& message) {
+        discard();
+        emit error(message);
+    };
+
+    for (const QString& featureName : featureNames) {
+        QString outputPath = resultPathFor(audioPath, featureName);
+        auto writer = std::make_unique<AudioStreamWriter>();
+        if (!writer->open(outputPath, Constants::AUDIO_SAMPLE_RATE)) {
+            fail(QString("Failed to open output file: %1").arg(outputPath));
+            return;
+        }
+        outputPaths.append(outputPath);
+        writers.push_back(std::move(writer));
+        buffers.push_back(std::make_unique<OverlapAddBuffer>(clipSamples, step, options.overlapRate, span));
+    }
+
+    torch::Tensor pending = torch::empty({0}, torch::kFloat); // Input samples from the next window start
+    torch::Tensor history = torch::empty({0}, torch::kFloat); // Up to gateContext samples before pending
+    int64_t nextChunk = 0;
+    int64_t totalSamples = 0;
+    int64_t skippedChunks = 0;
+
+    while (true) {
+        // Stopped streams leave no partial output behind
+        if (!control.checkpoint()) {
+            discard();
+            return;
+        }
+        ThreadBudget::instance().applyJobShare();
+
+        if (pending.size(0) < span + gateContext && !reader.atEnd()) {
+            torch::Tensor more = reader.read(span + gateContext - pending.size(0));
+            totalSamples += more.size(0);
+            pending = torch::cat({pending, more}, 0);
+        }
+
+        int64_t available = pending.size(0);
+        if (available == 0) {
+            break;
+        }
+
+        // A window starts every `step` samples while there is input left
+        int64_t numWindows = reader.atEnd()
+            ? std::min(batchSize, (available + step - 1) / step)
+            : batchSize;
+        int64_t needed = step * (numWindows - 1) + clipSamples;
+        torch::Tensor batchSamples = available < needed
+            ? torch::constant_pad_nd(pending, {0, needed - available}, 0)
+            : pending.slice(0, 0, needed);
+        torch::Tensor batch = batchSamples.unfold(0, clipSamples, step).unsqueeze(2).contiguous();
+
+        torch::Tensor keepMask;
+        if (options.similarityGate) {
+            torch::Tensor lookahead = available < needed
+                ? batchSamples
+                : pending.slice(0, 0, std::min(available, needed + gateContext));
+            keepMask = similarChunkMask(torch::cat({history, lookahead}, 0), history.size(0), numWindows, step,
+                                        conditions, options);
+        }
+
+        torch::Tensor separated = separateBatch(batch, conditions, options, &skippedChunks, keepMask);
+        if (!separated.defined()) {
+            fail("Processing chunk failed");
+            return;
+        }
+
+        for (int64_t f = 0; f < numFeatures; ++f) {
+            if (!buffers[f]->addChunks(nextChunk, separated.select(1, f))) {
+                fail("Overlap-add failed");
+                return;
+            }
+        }
+
+        if (options.dumpChunks) {
+            dumpSeparatedChunks(featureNames, nextChunk, separated);
+        }
+
+        nextChunk += numWindows;
+
+        // Samples before the next window start can no longer change; write them out now
+        for (int64_t f = 0; f < numFeatures; ++f) {
+            if (!writers[f]->write(buffers[f]->takeFinalized(buffers[f]->finalizedEnd(nextChunk)))) {
+                fail(QString("Failed to write output file: %1").arg(outputPaths[f]));
+                return;
+            }
+        }
+
+        const int64_t consumed = std::min(available, numWindows * step);
+        if (gateContext > 0) {
+            torch::Tensor recent = torch::cat({history, pending.slice(0, 0, consumed)}, 0);
+            history = recent.slice(0, std::max<int64_t>(0, recent.size(0) - gateContext)).clone();
+        }
+        pending = pending.slice(0, consumed);
+
+        double fileProgress = std::min(1.0, static_cast<double>(nextChunk) / estimatedChunks);
+        int progress = static_cast<int>(100.0 * (fileIndex + fileProgress) / fileCount);
+        emit progressUpdated(std::min(progress, 99));
+    }
+
+    if (totalSamples == 0) {
+        fail(QString("Failed to load audio waveform from: %1").arg(audioPath));
+        return;
+    }
+
+    for (int64_t f = 0; f < numFeatures; ++f) {
+        if (!writers[f]->write(buffers[f]->finish(totalSamples))) {
+            fail(QString("Failed to write output file: %1").arg(outputPaths[f]));
+            return;
+        }
+    }
+
+    emit chunksSkipped(audioPath, skippedChunks, nextChunk);
+    for (int64_t f = 0; f < numFeatures; ++f) {
+        writers[f]->close();
+        emit separationWritten(audioPath, featureNames[f], outputPaths[f]);
+    }
+    processedSamples += totalSamples;
+}
+
+int SeparationWorker::resolveWorkerThreads(const SeparationOptions& options) const
+{
+    if (options.workerThreads > 0) {
+        return options.workerThreads;
+    }
+    return std::max(1, leasedCores / Constants::SEPARATION_THREADS_PER_WORKER);
+}
+
+WorkStealingPool* SeparationWorker::ensurePool(int numThreads)
+{
+    // Pool threads size their intra-op pools per batch from the job's current
+    // share, so the pool survives other jobs starting and ending
+    if (!pool || pool->threadCount() != numThreads) {
+        pool.reset(new WorkStealingPool(numThreads));
+        qDebug() << "SeparationWorker: scheduler pool with" << numThreads << "threads";
+    }
+    return pool.get();
+}
+
+void SeparationWorker::processFilesScheduled(const QStringList& filePaths, const QStringList& featureNames,
+                                             const torch::Tensor& conditions, const SeparationOptions& options,
+                                             BoundedQueue<SeparatedResult>& writeQueue, QStringList& longFiles)
+{
+    int64_t step = stepFor(options);
+    if (step <= 0) {
+        emit error("Invalid step size calculated from clipSamples and overlapRate");
+        return;
+    }
+
+    WorkStealingPool* workers = ensurePool(resolveWorkerThreads(options));
+
+    auto job = std::make_shared<ScheduledJob>();
+    job->featureNames = featureNames;
+    job->conditions = conditions;
+    job->options = options;
+    job->step = step;
+    job->totalFiles = filePaths.size();
+    job->writeQueue = &writeQueue;
+    job->pendingFiles = filePaths;
+
+    // Bound the number of decoded files held in memory at once; each finished
+    // file starts the next decode
+    const int filesInFlight = std::min<int>(filePaths.size(), workers->threadCount() * 2);
+    for (int i = 0; i < filesInFlight; ++i) {
+        scheduleNextFile(job);
+    }
+
+    workers->waitForIdle();
+    longFiles = job->longFiles;
+}
+
+void SeparationWorker::scheduleNextFile(const std::shared_ptr<ScheduledJob>& job)
+{
+    QString audioPath;
+    {
+        std::lock_guard<std::mutex> lock(job->queueMutex);
+        if (job->pendingFiles.isEmpty() || control.isStopped()) {
+            return;
+        }
+        audioPath = job->pendingFiles.takeFirst();
+    }
+
+    pool->submit([this, job, audioPath]() {
+        decodeScheduledFile(job, audioPath);
+    });
+}
+
+void SeparationWorker::decodeScheduledFile(const std::shared_ptr<ScheduledJob>& job, const QString& audioPath)
+{
+    if (!control.checkpoint()) {
+        return;
+    }
+
+    bool tooLong = false;
+    torch::Tensor waveform = decodeInput(audioPath, job->options, &tooLong);
+    if (tooLong) {
+        std::lock_guard<std::mutex> lock(job->queueMutex);
+        job->longFiles.append(audioPath);
+    }
+    if (!waveform.defined()) {
+        // Long files are counted when they are streamed
+        if (!tooLong) {
+            addScheduledProgress(job, 1.0 / job->totalFiles);
+        }
+        scheduleNextFile(job);
+        return;
+    }
+
+    auto file = std::make_shared<ScheduledFile>();
+    file->audioPath = audioPath;
+    file->totalSamples = waveform.size(0);
+    file->numChunks = (file->totalSamples + job->step - 1) / job->step;
+
+    const int64_t paddedLength = job->step * (file->numChunks - 1) + clipSamples;
+    torch::Tensor padded = torch::constant_pad_nd(waveform, {0, paddedLength - file->totalSamples}, 0);
+    file->windows = padded.unfold(0, clipSamples, job->step);
+    if (job->options.similarityGate) {
+        file->keepMask = similarChunkMask(padded, 0, file->numChunks, job->step, job->conditions, job->options);
+    }
+    for (int f = 0; f < job->featureNames.size(); ++f) {
+        file->buffers.push_back(std::make_unique<OverlapAddBuffer>(clipSamples, job->step, job->options.overlapRate, paddedLength));
+    }
+
+    const int64_t batchSize = windowsPerBatch(job->options, job->featureNames.size());
+    const int64_t numBatches = (file->numChunks + batchSize - 1) / batchSize;
+    file->remainingBatches = numBatches;
+
+    // Batches land on this thread's deque; idle threads steal them
+    for (int64_t first = 0; first < file->numChunks; first += batchSize) {
+        int64_t last = std::min(first + batchSize, file->numChunks);
+        pool->submit([this, job, file, first, last]() {
+            runScheduledBatch(job, file, first, last);
+        });
+    }
+}
+
+void SeparationWorker::runScheduledBatch(const std::shared_ptr<ScheduledJob>& job,
+                                         const std::shared_ptr<ScheduledFile>& file, int64_t first, int64_t last)
+{
+    // Remaining batches of a stopped job drain without running the model
+    if (!control.checkpoint()) {
+        file->failed = true;
+    }
+
+    if (!file->failed) {
+        // The job's share split between pool threads so concurrent forwards do not oversubscribe
+        ThreadBudget::instance().applyJobShare(pool->threadCount());
+        torch::Tensor batch = file->windows.slice(0, first, last).unsqueeze(2).contiguous();
+        int64_t skipped = 0;
+        torch::Tensor separated = separateBatch(batch, job->conditions, job->options, &skipped,
+                                                file->keepMask.defined() ? file->keepMask.slice(0, first, last) : torch::Tensor());
+        file->skippedChunks += skipped;
+
+        bool added = separated.defined();
+        if (added) {
+            std::lock_guard<std::mutex> lock(file->bufferMutex);
+            for (size_t f = 0; f < file->buffers.size() && added; ++f) {
+                added = file->buffers[f]->addChunks(first, separated.select(1, static_cast<int64_t>(f)));
+            }
+        }
+
+        if (!added) {
+            if (!file->failed.exchange(true)) {
+                emit error(QString("Processing chunk failed: %1").arg(file->audioPath));
+            }
+        } else if (job->options.dumpChunks) {
+            dumpSeparatedChunks(job->featureNames, first, separated);
+        }
+    }
+
+    addScheduledProgress(job, static_cast<double>(last - first) / file->numChunks / job->totalFiles);
+
+    // The thread that lands the last batch finalizes the file
+    if (--file->remainingBatches == 0) {
+        finalizeScheduledFile(job, file);
+    }
+}
+
+void SeparationWorker::finalizeScheduledFile(const std::shared_ptr<ScheduledJob>& job,
+                                             const std::shared_ptr<ScheduledFile>& file)
+{
+    if (!file->failed) {
+        emit chunksSkipped(file->audioPath, file->skippedChunks, file->numChunks);
+        SeparatedResult result;
+        result.audioPath = file->audioPath;
+        result.featureNames = job->featureNames;
+        for (const auto& buffer : file->buffers) {
+            result.outputs.push_back(buffer->finish(file->totalSamples));
+        }
+        job->writeQueue->push(std::move(result));
+    }
+
+    // Release the decoded input and overlap buffers before starting the next file
+    file->buffers.clear();
+    file->windows = torch::Tensor();
+    file->keepMask = torch::Tensor();
+
+    scheduleNextFile(job);
+}
+
+void SeparationWorker::addScheduledProgress(const std::shared_ptr<ScheduledJob>& job, double fraction)
+{
+    int progress;
+    {
+        std::lock_guard<std::mutex> lock(job->progressMutex);
+        job->progress += fraction;
+        progress = static_cast<int>(100.0 * job->progress);
+    }
+    emit progressUpdated(std::min(progress, 99));
 }
@@ -4,6 +4,12 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QMetaType>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
 #include <vector>
 #ifndef Q_MOC_RUN
 #undef slots
@@ -12,46 +18,207 @@
 #endif
 #include "zero_shot_asp_feature_extractor.h"
 #include "constants.h"
+#include "boundedqueue.h"
+#include "jobcontrol.h"
+
+class WorkStealingPool;
+struct ScheduledJob;
+struct ScheduledFile;
+struct SeparatedResult;
+class HTSATProcessor;
+
+/**
+ * @brief What a chunk skipped by the silence gate contributes to the output.
+ */
+enum class SilenceFill {
+    Zeros,      ///< Write silence
+    Passthrough ///< Copy the (near-silent) input through unchanged
+};
+
+/**
+ * @brief Numeric precision of the models used for a job.
+ */
+enum class ModelPrecision {
+    Float32,  ///< Reference models
+    Int8,     ///< Dynamically quantized variants (linear/attention weights in INT8)
+    BFloat16  ///< Reference models cast to bfloat16; gated by an accuracy self-check
+};
+
+/**
+ * @brief Per-job tuning knobs for the separation worker.
+ */
+struct SeparationOptions
+{
+    int batchSize = Constants::SEPARATION_BATCH_SIZE; ///< Rows (window x feature pairs) stacked into one forward call
+    bool dumpChunks = false;                          ///< Debug: also write the mono input and every chunk to temp_chunks
+    int streamingThresholdSeconds = Constants::STREAMING_THRESHOLD_SECONDS; ///< Stream inputs longer than this (0 = always, <0 = never)
+    int workerThreads = 0;                            ///< Inference threads sharing the model (0 = automatic, 1 = sequential)
+    float silenceRmsThreshold = Constants::SILENCE_GATE_RMS;   ///< Chunks under both thresholds skip inference (0 disables)
+    float silencePeakThreshold = Constants::SILENCE_GATE_PEAK;
+    SilenceFill silenceFill = SilenceFill::Zeros;     ///< Output used for skipped chunks
+    bool similarityGate = false;                      ///< HTSAT pre-pass: separate only regions that resemble a query
+    float similarityThreshold = Constants::SIMILARITY_GATE_THRESHOLD;
+    int similarityNeighbourhood = Constants::SIMILARITY_GATE_NEIGHBOURHOOD;
+    ModelPrecision precision = ModelPrecision::Float32; ///< Separation and similarity pre-pass only; features are always embedded in float32
+    float overlapRate = Constants::AUDIO_OVERLAP_RATE; ///< Overlap between consecutive chunks (0 to 0.9)
+    QString tier;                                     ///< SeparationTiers name the options came from, for reporting
+};
+Q_DECLARE_METATYPE(SeparationOptions)
 
 class SeparationWorker : public QObject
 {
     Q_OBJECT
 public:
     explicit SeparationWorker(QObject* parent = nullptr);
-    ~SeparationWorker() = default;
+    ~SeparationWorker();
+
+    // 確保常駐模型已載入（首次呼叫時載入，之後重複使用；每種精度各一份）
+    bool ensureModelLoaded(ModelPrecision precision = ModelPrecision::Float32);
+
+    // 常駐模型是否已載入
+    bool isModelLoaded() const;
+
+    // 取消 / 暫停 / 搶占旗標，可由任何執行緒呼叫；每個 chunk 之間檢查
+    JobControl* jobControl();
 
     // 載入 query 特徵檔
     torch::Tensor loadFeature(const QString& featurePath);
 
-    // 分段呼叫模型 forward
+    // 分離結果的輸出路徑（每個 feature 各一個檔案）
+    static QString resultPathFor(const QString& audioPath, const QString& featureName);
+
+    // 分段呼叫模型 forward（waveform: (N, clipSamples, 1)，N 個 chunk 一次推論）
     torch::Tensor processChunk(const torch::Tensor& waveform,
                                const torch::Tensor& condition,
                                ZeroShotASPFeatureExtractor* extractor);
 
+    // 同一批 chunk 對多個 feature 一次推論；低於靜音門檻或 keepMask 為 false 的 chunk 不送進模型
+    // batch: (N, clipSamples, 1)，conditions: (F, 2048)，keepMask: (N) bool，return: (N, F, clipSamples, 1)
+    torch::Tensor separateBatch(const torch::Tensor& batch, const torch::Tensor& conditions,
+                                const SeparationOptions& options, int64_t* skippedChunks = nullptr,
+                                const torch::Tensor& keepMask = torch::Tensor());
+
+    // HTSAT 預篩：chunk 0 從 samples 的第 offset 個樣本開始，前後多餘的樣本只當鄰近區域的上下文
+    // 回傳 (numChunks) bool，鄰近區域與任一 query 相似者為 true
+    torch::Tensor similarChunkMask(const torch::Tensor& samples, int64_t offset, int64_t numChunks, int64_t step,
+                                   const torch::Tensor& conditions, const SeparationOptions& options);
+
     // Overlap-Add 合併多個 chunk
     torch::Tensor doOverlapAdd(const std::vector<torch::Tensor>& chunks);
-    torch::Tensor doOverlapAdd(const QStringList& chunkFilePaths);
+    torch::Tensor doOverlapAdd(const torch::Tensor& chunks); // chunks: (N, chunkSize, 1)
 
 signals:
-    // 單個 chunk 完成
+    // 單個 chunk 完成（僅在 SeparationOptions::dumpChunks 開啟時發送，供除錯寫檔）
     void chunkReady(const QString& audioPath,
                     const QString& featureName,
                     const torch::Tensor& chunkData);
 
-    // 單檔案所有 chunk OLA 完成
-    void separationFinished(const QString& audioPath,
-                            const QString& featureName,
-                            const torch::Tensor& finalTensor);
+    // 結果已由寫檔階段寫入 outputPath（每個 feature 各一次）
+    void separationWritten(const QString& audioPath,
+                           const QString& featureName,
+                           const QString& outputPath);
     void progressUpdated(int value);
+
+    // 靜音門檻或相似度預篩略過的 chunk 數
+    void chunksSkipped(const QString& audioPath, qint64 skipped, qint64 total);
     void error(const QString& errorMessage);
 
+    // processFile 結束（interrupted 表示被取消或被搶占，原因見 jobControl()->stopReason()）
+    void jobEnded(bool interrupted);
+
+    // 非 float32 精度第一次使用時，與 float32 比較同一個 chunk 的速度與輸出 SNR
+    void precisionCompared(const QString& precision, double speedup, double snrDb);
+
+    // bf16 自我檢查未通過，此精度之後的工作都改用 float32
+    void precisionRefused(const QString& precision, const QString& reason);
+
+    // warmUp 結束
+    void warmedUp(bool ok);
+
+    // releaseModel 放開了分離模型（取消工作或手動釋放），下一個工作會重新載入
+    void modelReleased();
+
+    // 工作完成時量到的 realtime factor（處理時間 / 音訊長度，不含模型載入與精度檢查）
+    // tier 為 options.tier，precision 為實際使用的精度（可能已退回 float32）
+    void realtimeFactorMeasured(const QString& tier, const QString& precision, double realtimeFactor);
+
 
 public slots:
     // Qt Slot：處理 ResourceManager 的請求
-    void processFile(const QStringList& filePaths, const QString& featureName);
+    // 一次讀檔、分段，對 featureNames 中每個 feature 各輸出一個結果
+    void processFile(const QStringList& filePaths, const QStringList& featureNames,
+                     const SeparationOptions& options = SeparationOptions());
+
+    // 預先載入模型，讓第一個請求不必等待反序列化
+    void preloadModel();
+
+    // 載入模型並跑一次假資料 forward，第一個請求也不必付 JIT 第一次執行的成本
+    void warmUp();
+
+    // 釋放常駐模型（記憶體吃緊時使用），下次處理時會重新載入
+    void releaseModel();
 
 private:
-    void processSingleFile(const QString& audioPath, const QString& featureName);
-    float overlapRate;
+    void separateFiles(const QStringList& filePaths, const QStringList& featureNames,
+                       const SeparationOptions& options);
+
+    // Pipeline: decode thread -> inference (this thread) -> write thread, bounded queues in between.
+    // Files over the streaming threshold are not decoded; they are appended to longFiles
+    void processFilesPipelined(const QStringList& filePaths, const QStringList& featureNames,
+                               const torch::Tensor& conditions, const SeparationOptions& options,
+                               BoundedQueue<SeparatedResult>& writeQueue, QStringList& longFiles);
+    torch::Tensor decodeInput(const QString& audioPath, const SeparationOptions& options, bool* tooLong = nullptr);
+    bool separateWaveform(const QString& audioPath, const torch::Tensor& waveform,
+                          const QStringList& featureNames, const torch::Tensor& conditions,
+                          const SeparationOptions& options, int fileIndex, int fileCount,
+                          std::vector<torch::Tensor>& outputs);
+    void writeResults(BoundedQueue<SeparatedResult>& queue);
+    void processSingleFileStreaming(const QString& audioPath, const QStringList& featureNames,
+                                    const torch::Tensor& conditions, const SeparationOptions& options,
+                                    int fileIndex, int fileCount);
+    bool ensureEmbeddingModelLoaded(ModelPrecision precision);
+    ModelPrecision gateEmbeddingPrecision(ModelPrecision precision) const; // HTSAT precision the gate runs in
+    ZeroShotASPFeatureExtractor* extractorFor(ModelPrecision precision);
+    bool unloadExtractor(ZeroShotASPFeatureExtractor* model); // Drops the handle and frees the module if idle
+    bool unloadExtractor(ZeroShotASPFeatureExtractor* model); // Drops the handle and frees the module if idle
+    torch::Tensor referenceClip(const QString& audioPath) const;
+    double comparePrecision(const QString& audioPath, const torch::Tensor& condition, ModelPrecision precision);
+    double compareEmbeddingPrecision(const QString& audioPath, ModelPrecision precision);
+    bool verifyPrecision(const QString& audioPath, const torch::Tensor& condition,
+                         const SeparationOptions& options);
+    torch::Tensor runSeparation(const torch::Tensor& batch, const torch::Tensor& conditions,
+                                ZeroShotASPFeatureExtractor* model);
+    int64_t windowsPerBatch(const SeparationOptions& options, int64_t numFeatures) const;
+    int64_t stepFor(const SeparationOptions& options) const;
+    void dumpSeparatedChunks(const QStringList& featureNames, int64_t firstChunk, const torch::Tensor& separated);
+
+    // Work-stealing scheduler: every (file, chunk batch) pair is a task on the shared pool
+    int resolveWorkerThreads(const SeparationOptions& options) const;
+    WorkStealingPool* ensurePool(int numThreads);
+    void processFilesScheduled(const QStringList& filePaths, const QStringList& featureNames,
+                               const torch::Tensor& conditions, const SeparationOptions& options,
+                               BoundedQueue<SeparatedResult>& writeQueue, QStringList& longFiles);
+    void scheduleNextFile(const std::shared_ptr<ScheduledJob>& job);
+    void decodeScheduledFile(const std::shared_ptr<ScheduledJob>& job, const QString& audioPath);
+    void runScheduledBatch(const std::shared_ptr<ScheduledJob>& job,
+                           const std::shared_ptr<ScheduledFile>& file, int64_t first, int64_t last);
+    void finalizeScheduledFile(const std::shared_ptr<ScheduledJob>& job,
+                               const std::shared_ptr<ScheduledFile>& file);
+    void addScheduledProgress(const std::shared_ptr<ScheduledJob>& job, double fraction);
+
+    std::unique_ptr<WorkStealingPool> pool; ///< Inference threads, created on first scheduled job
+    int leasedCores;                        ///< Job share from ThreadBudget when the job started; sizes the pool
+    JobControl control;                     ///< Stop/pause flags for the running job
+    ZeroShotASPFeatureExtractor* extractor; ///< 常駐的分離模型，跨檔案與跨工作重複使用
+    std::map<ModelPrecision, ZeroShotASPFeatureExtractor*> variantExtractors; ///< 非 float32 的分離模型，第一次使用時載入
+    HTSATProcessor* embeddingModel;         ///< 相似度預篩用，第一次開啟 similarityGate 時載入
+    ModelPrecision embeddingPrecision;      ///< embeddingModel 目前載入的精度
+    std::set<ModelPrecision> comparedPrecisions; ///< 已回報過與 float32 比較結果的精度
+    std::set<ModelPrecision> verifiedEmbeddingPrecisions; ///< HTSAT 已通過 cosine 檢查的精度
+    std::set<ModelPrecision> refusedPrecisions;  ///< 自我檢查未通過、改用 float32 的精度
+    std::atomic<int64_t> processedSamples{0}; ///< Input samples of the files the running job finished
+    std::chrono::steady_clock::time_point inferenceStart; ///< When the running job's models were ready
+    ModelPrecision jobPrecision;            ///< Precision the running job actually separates with
+    float overlapRate;                      ///< Default overlap, used by doOverlapAdd
     int clipSamples;
 };
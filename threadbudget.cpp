@@ -0,0 +1,150 @@
+#include "threadbudget.h"
+#include "constants.h"
+#include <QDebug>
+#include <QThread>
+#include <QtGlobal>
+#include <algorithm>
+
+#ifndef Q_MOC_RUN
+#undef slots
+#include <ATen/Parallel.h>
+#define slots
+#endif
+
+namespace {
+
+int positiveEnv(const char* name)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : 0;
+}
+
+} // namespace
+
+ThreadBudget::JobLease::JobLease(const QString& jobName)
+{
+    ThreadBudget::instance().acquire(jobName);
+}
+
+ThreadBudget::JobLease::~JobLease()
+{
+    ThreadBudget::instance().release();
+}
+
+int ThreadBudget::JobLease::cores() const
+{
+    return ThreadBudget::instance().jobShare();
+}
+
+ThreadBudget& ThreadBudget::instance()
+{
+    static ThreadBudget budget;
+    return budget;
+}
+
+ThreadBudget::ThreadBudget()
+    : m_totalThreads(std::max(1, QThread::idealThreadCount())),
+      m_interopThreads(Constants::DEFAULT_INTEROP_THREADS),
+      m_dspThreads(Constants::DEFAULT_DSP_THREADS)
+{
+}
+
+ThreadBudget::Config ThreadBudget::configFromEnvironment()
+{
+    Config config;
+    config.totalThreads = positiveEnv(Constants::ENV_NUM_THREADS);
+    config.interopThreads = positiveEnv(Constants::ENV_INTEROP_THREADS);
+    config.dspThreads = positiveEnv(Constants::ENV_DSP_THREADS);
+    return config;
+}
+
+void ThreadBudget::configure(const Config& config)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_totalThreads = config.totalThreads > 0 ? config.totalThreads : std::max(1, QThread::idealThreadCount());
+    m_dspThreads = config.dspThreads > 0 ? config.dspThreads : Constants::DEFAULT_DSP_THREADS;
+    // Keep at least one core for inference
+    m_dspThreads = std::min(m_dspThreads, std::max(0, m_totalThreads - 1));
+
+    const int interop = config.interopThreads > 0 ? config.interopThreads : Constants::DEFAULT_INTEROP_THREADS;
+    if (!m_interopConfigured) {
+        try {
+            at::set_num_interop_threads(interop);
+            m_interopThreads = interop;
+        } catch (const c10::Error& e) {
+            // The pool already started; keep whatever size it has
+            m_interopThreads = at::get_num_interop_threads();
+            qDebug() << "ThreadBudget: inter-op pool already running with" << m_interopThreads << "threads";
+        }
+        m_interopConfigured = true;
+    }
+
+    // The GUI thread only runs small tensor ops; workers set their own share per job
+    at::set_num_threads(std::max(1, m_totalThreads - m_dspThreads));
+}
+
+void ThreadBudget::enterDspThread()
+{
+    at::set_num_threads(1);
+}
+
+int ThreadBudget::totalThreads() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_totalThreads;
+}
+
+int ThreadBudget::interopThreads() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_interopThreads;
+}
+
+int ThreadBudget::dspThreads() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dspThreads;
+}
+
+int ThreadBudget::jobShare() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::max(1, std::max(1, m_totalThreads - m_dspThreads) / std::max(1, m_activeJobs));
+}
+
+int ThreadBudget::applyJobShare(int workers)
+{
+    // Last size set on this thread, so unchanged shares cost one lock
+    thread_local int applied = 0;
+    const int threads = std::max(1, jobShare() / std::max(1, workers));
+    if (threads != applied) {
+        at::set_num_threads(threads);
+        applied = threads;
+    }
+    return threads;
+}
+
+QString ThreadBudget::describe() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return QString("Threads: %1 total = %2 inference + %3 decode/write, %4 inter-op, %5 job(s) running")
+        .arg(m_totalThreads).arg(std::max(1, m_totalThreads - m_dspThreads)).arg(m_dspThreads)
+        .arg(m_interopThreads).arg(m_activeJobs);
+}
+
+void ThreadBudget::acquire(const QString& jobName)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_activeJobs;
+    }
+    // The job's own thread runs single-threaded stages and forwards with the full share
+    qDebug() << "ThreadBudget:" << jobName << "leased" << applyJobShare() << "cores";
+}
+
+void ThreadBudget::release()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_activeJobs = std::max(0, m_activeJobs - 1);
+}
@@ -0,0 +1,101 @@
+#ifndef THREADBUDGET_H
+#define THREADBUDGET_H
+
+#include <QString>
+#include <mutex>
+
+/**
+ * @brief Process-wide split of CPU cores between libtorch and the app's own threads.
+ *
+ * libtorch sizes its intra-op pool to every core by default, and each Qt worker,
+ * pipeline stage and scheduler thread would otherwise inherit that size, so two
+ * busy workers ask for twice the machine. The budget reserves cores for the
+ * decode/write (DSP) stages, sets the inter-op pool once at startup, and gives
+ * each running job an equal share of the rest through a JobLease. Shares are
+ * recomputed whenever a job starts or ends; running jobs pick up the new size
+ * through applyJobShare() between batches.
+ *
+ * Configured from the environment (AST_NUM_THREADS, AST_INTEROP_THREADS,
+ * AST_DSP_THREADS) and the matching command-line options, which take precedence.
+ */
+class ThreadBudget
+{
+public:
+    struct Config {
+        int totalThreads = 0;   ///< Cores the app may use (0 = QThread::idealThreadCount())
+        int interopThreads = 0; ///< libtorch inter-op pool size (0 = Constants::DEFAULT_INTEROP_THREADS)
+        int dspThreads = 0;     ///< Cores kept for decode/resample/write stages (0 = Constants::DEFAULT_DSP_THREADS)
+    };
+
+    /**
+     * @brief Counts one running job for as long as the lease lives.
+     *
+     * The share is inference cores divided by the number of jobs running now, so
+     * it shrinks when another job starts and grows back when one ends.
+     */
+    class JobLease
+    {
+    public:
+        explicit JobLease(const QString& jobName);
+        ~JobLease();
+
+        JobLease(const JobLease&) = delete;
+        JobLease& operator=(const JobLease&) = delete;
+
+        int cores() const; ///< The job's current share
+    };
+
+    static ThreadBudget& instance();
+
+    /**
+     * @brief Sets the budget and sizes libtorch's pools; call once before any model is loaded.
+     *
+     * The inter-op pool can only be sized before libtorch first uses it, so later
+     * calls only change the core split.
+     */
+    void configure(const Config& config);
+
+    /**
+     * @brief Reads AST_NUM_THREADS, AST_INTEROP_THREADS and AST_DSP_THREADS; unset values stay 0.
+     */
+    static Config configFromEnvironment();
+
+    /**
+     * @brief Limits libtorch on the calling thread; used by decode and write stage threads.
+     */
+    static void enterDspThread();
+
+    /**
+     * @brief Sizes libtorch on the calling thread to its slice of the current job share.
+     *
+     * Called by inference threads before each batch; `workers` is how many threads
+     * of the same job split the share. Only touches libtorch when the size changed.
+     * @return The intra-op thread count now in effect on this thread.
+     */
+    int applyJobShare(int workers = 1);
+
+    int totalThreads() const;
+    int interopThreads() const;
+    int dspThreads() const;
+    int jobShare() const; ///< Inference cores per running job, at least 1
+
+    /**
+     * @brief One line describing the effective allocation, for logs and the status bar.
+     */
+    QString describe() const;
+
+private:
+    ThreadBudget();
+
+    void acquire(const QString& jobName);
+    void release();
+
+    mutable std::mutex m_mutex;
+    int m_totalThreads;
+    int m_interopThreads;
+    int m_dspThreads;
+    int m_activeJobs = 0;
+    bool m_interopConfigured = false;
+};
+
+#endif // THREADBUDGET_H
@@ -0,0 +1,66 @@
+#include "torchscriptbackend.h"
+
+TorchScriptEmbeddingBackend::TorchScriptEmbeddingBackend(ModelRegistry::Handle model, torch::ScalarType dtype)
+    : m_model(std::move(model)), m_dtype(dtype)
+{
+}
+
+torch::Tensor TorchScriptEmbeddingBackend::embed(const torch::Tensor& clips)
+{
+    c10::InferenceMode inferenceMode;
+    std::vector<torch::jit::IValue> inputs;
+    inputs.push_back(clips.to(m_dtype).contiguous());
+    auto outputDict = m_model->forward(inputs).toGenericDict();
+    return outputDict.at("latent_output").toTensor().to(torch::kFloat).reshape({clips.size(0), -1});
+}
+
+QString TorchScriptEmbeddingBackend::name() const
+{
+    return "TorchScript";
+}
+
+TorchScriptSeparationBackend::TorchScriptSeparationBackend(ModelRegistry::Handle model, torch::ScalarType dtype)
+    : m_model(std::move(model)),
+      m_dtype(dtype),
+      m_splitInference(m_model->find_method("encode").has_value() && m_model->find_method("decode").has_value())
+{
+}
+
+torch::Tensor TorchScriptSeparationBackend::separate(const torch::Tensor& waveform, const torch::Tensor& condition)
+{
+    c10::InferenceMode inferenceMode;
+    std::vector<torch::jit::IValue> inputs = {waveform.to(m_dtype), condition.to(m_dtype)};
+    return m_model->forward(inputs).toTensor().to(torch::kFloat);
+}
+
+torch::Tensor TorchScriptSeparationBackend::separateMany(const torch::Tensor& waveform,
+                                                         const torch::Tensor& conditions)
+{
+    if (!m_splitInference) {
+        return SeparationBackend::separateMany(waveform, conditions);
+    }
+
+    c10::InferenceMode inferenceMode;
+    const int64_t numWindows = waveform.size(0);
+    const int64_t numFeatures = conditions.size(0);
+    // The mixture side (STFT + encoder) runs once per chunk; only the conditioned decoder runs per query
+    torch::jit::IValue encoding = m_model->get_method("encode")({waveform.to(m_dtype)});
+    torch::jit::Method decode = m_model->get_method("decode");
+    std::vector<torch::Tensor> outputs;
+    outputs.reserve(numFeatures);
+    for (int64_t f = 0; f < numFeatures; ++f) {
+        torch::Tensor condition = conditions.slice(0, f, f + 1).expand({numWindows, conditions.size(1)});
+        outputs.push_back(decode({encoding, condition.to(m_dtype)}).toTensor().to(torch::kFloat));
+    }
+    return torch::stack(outputs, 1);
+}
+
+bool TorchScriptSeparationBackend::sharesMixtureEncoding() const
+{
+    return m_splitInference;
+}
+
+QString TorchScriptSeparationBackend::name() const
+{
+    return "TorchScript";
+}
@@ -0,0 +1,50 @@
+#ifndef TORCHSCRIPTBACKEND_H
+#define TORCHSCRIPTBACKEND_H
+
+#include "inferencebackend.h"
+#include "modelregistry.h"
+
+/**
+ * @brief HTSAT embedding through a TorchScript module whose forward returns {"latent_output": (B, 2048)}.
+ */
+class TorchScriptEmbeddingBackend : public EmbeddingBackend
+{
+public:
+    /**
+     * @param model Module shared through ModelRegistry.
+     * @param dtype Parameter dtype of the module; inputs are cast to it and outputs back to float32.
+     */
+    TorchScriptEmbeddingBackend(ModelRegistry::Handle model, torch::ScalarType dtype);
+
+    torch::Tensor embed(const torch::Tensor& clips) override;
+    QString name() const override;
+
+private:
+    ModelRegistry::Handle m_model;
+    torch::ScalarType m_dtype;
+};
+
+/**
+ * @brief ZeroShotASP separation through a TorchScript module.
+ *
+ * forward(waveform, condition) separates one chunk per condition. When the
+ * module also exports encode(waveform) and decode(encoding, condition), the
+ * mixture encoding is computed once per chunk and shared by every query.
+ */
+class TorchScriptSeparationBackend : public SeparationBackend
+{
+public:
+    TorchScriptSeparationBackend(ModelRegistry::Handle model, torch::ScalarType dtype);
+
+    torch::Tensor separate(const torch::Tensor& waveform, const torch::Tensor& condition) override;
+    torch::Tensor separateMany(const torch::Tensor& waveform, const torch::Tensor& conditions) override;
+    bool sharesMixtureEncoding() const override;
+    QString name() const override;
+
+private:
+    ModelRegistry::Handle m_model;
+    torch::ScalarType m_dtype;
+    bool m_splitInference; ///< Module exports encode / decode
+};
+
+#endif // TORCHSCRIPTBACKEND_H
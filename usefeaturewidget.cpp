@@ -6,6 +6,8 @@
 
 #include "resourcemanager.h"
 #include "constants.h"
+#include "separationtiers.h"
+#include "featurestore.h"
 
 UseFeatureWidget::UseFeatureWidget(QWidget *parent)
     : FileManagerWidget(ResourceManager::FileType::WavForSeparation, parent)
@@ -21,6 +23,10 @@ UseFeatureWidget::UseFeatureWidget(QWidget *parent)
     connect(rm, &ResourceManager::processingProgress, this, &UseFeatureWidget::onProcessingProgress);
     connect(rm, &ResourceManager::processingFinished, this, &UseFeatureWidget::onProcessingFinished);
     connect(rm, &ResourceManager::separationProcessingFinished, this, &UseFeatureWidget::onSeparationProcessingFinished);
+    connect(rm, &ResourceManager::processingCancelled, this, [this]() {
+        processButton->setEnabled(true);
+        resultLabel->setText("Processing cancelled.");
+    });
 }
 
 void UseFeatureWidget::setupUI()
@@ -48,10 +54,12 @@ void UseFeatureWidget::setupFeatureSelectionUI()
     featureLabel = new QLabel(Constants::SELECT_FEATURE_LABEL, this);
     mainLayout->addWidget(featureLabel);
 
-    // Create horizontal layout for combobox and delete button
+    // Create horizontal layout for feature list and delete button
     QHBoxLayout* featureLayout = new QHBoxLayout();
-    featureComboBox = new QComboBox(this);
-    featureLayout->addWidget(featureComboBox);
+    featureList = new QListWidget(this);
+    featureList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    featureList->setMaximumHeight(100);
+    featureLayout->addWidget(featureList);
 
     QPushButton* deleteButton = new QPushButton(Constants::DELETE_BUTTON, this);
     featureLayout->addWidget(deleteButton);
@@ -75,6 +83,24 @@ void UseFeatureWidget::setupProcessingUI()
         return;
     }
 
+    QHBoxLayout* tierLayout = new QHBoxLayout();
+    tierLayout->addWidget(new QLabel(Constants::SEPARATION_TIER_LABEL, this));
+    tierCombo = new QComboBox(this);
+    for (const QString& tier : SeparationTiers::names()) {
+        tierCombo->addItem(tier, tier);
+    }
+    tierCombo->setCurrentIndex(tierCombo->findData(ResourceManager::instance()->defaultSeparationTier()));
+    tierLayout->addWidget(tierCombo, 1);
+    mainLayout->addLayout(tierLayout);
+    updateTierLabels();
+
+    int8Check = new QCheckBox(Constants::INT8_INFERENCE_CHECKBOX, this);
+    mainLayout->addWidget(int8Check);
+    bf16Check = new QCheckBox(Constants::BF16_INFERENCE_CHECKBOX, this);
+    mainLayout->addWidget(bf16Check);
+    similarityGateCheck = new QCheckBox(Constants::SIMILARITY_GATE_CHECKBOX, this);
+    mainLayout->addWidget(similarityGateCheck);
+
     processButton = new QPushButton(Constants::PROCESS_BUTTON, this);
     mainLayout->addWidget(processButton);
 
@@ -94,6 +120,17 @@ void UseFeatureWidget::setupConnections()
 {
     connect(processButton, &QPushButton::clicked, this, &UseFeatureWidget::onProcessClicked);
 
+    connect(ResourceManager::instance(), &ResourceManager::tierRealtimeFactorUpdated,
+            this, &UseFeatureWidget::updateTierLabels);
+
+    // One reduced precision per job
+    connect(int8Check, &QCheckBox::toggled, this, [this](bool checked) {
+        if (checked) bf16Check->setChecked(false);
+    });
+    connect(bf16Check, &QCheckBox::toggled, this, [this](bool checked) {
+        if (checked) int8Check->setChecked(false);
+    });
+
     // Find the delete button from the feature layout
     QVBoxLayout* mainLayout = qobject_cast<QVBoxLayout*>(this->QWidget::layout());
     if (mainLayout) {
@@ -107,21 +144,42 @@ void UseFeatureWidget::setupConnections()
     }
 }
 
+/**
+ * @brief Refreshes the tier combo box text: what each tier sets and its last measured realtime factor.
+ */
+void UseFeatureWidget::updateTierLabels()
+{
+    ResourceManager* rm = ResourceManager::instance();
+    for (int i = 0; i < tierCombo->count(); ++i) {
+        const QString tier = tierCombo->itemData(i).toString();
+        QString text = QString("%1 (%2)").arg(tier, SeparationTiers::describe(tier));
+        const double realtimeFactor = rm->tierRealtimeFactor(tier);
+        if (realtimeFactor > 0.0) {
+            text += QString(" - RTF %1").arg(realtimeFactor, 0, 'f', 3);
+        }
+        tierCombo->setItemText(i, text);
+    }
+}
+
 void UseFeatureWidget::loadFeatures()
 {
-    featureComboBox->clear();
+    featureList->clear();
     QDir featuresDir("output_features");
     if (!featuresDir.exists()) {
         QMessageBox::warning(this, "Warning", "output_features folder does not exist.");
         return;
     }
-    QStringList featureFiles = featuresDir.entryList(QStringList() << "*.txt", QDir::Files);
-    // Remove the .txt extension for display
+    QStringList featureFiles = featuresDir.entryList(FeatureStore::featureFileFilters(), QDir::Files);
+    // Remove the .feat / .txt extension for display; a name saved in both formats is listed once
     QStringList displayNames;
     for (const QString& file : featureFiles) {
         displayNames.append(QFileInfo(file).baseName());
     }
-    featureComboBox->addItems(displayNames);
+    displayNames.removeDuplicates();
+    featureList->addItems(displayNames);
+    if (featureList->count() > 0) {
+        featureList->setCurrentRow(0);
+    }
 }
 
 void UseFeatureWidget::refreshFeatures()
@@ -229,8 +287,12 @@ void UseFeatureWidget::addSingleFile(const QString& filePath)
 
 void UseFeatureWidget::onProcessClicked()
 {
-    QString selectedFeature = featureComboBox->currentText();
-    if (selectedFeature.isEmpty()) {
+    // Every selected feature is separated in the same pass over the input
+    QStringList selectedFeatures;
+    for (QListWidgetItem* item : featureList->selectedItems()) {
+        selectedFeatures.append(item->text());
+    }
+    if (selectedFeatures.isEmpty()) {
         QMessageBox::warning(this, "Warning", "Please select a sound feature.");
         return;
     }
@@ -269,7 +331,15 @@ void UseFeatureWidget::onProcessClicked()
     processButton->setEnabled(false);
 
     // Start async processing
-    rm->startSeparateAudio(filesToProcess, selectedFeature);
+    // The tier sets overlap, precision and batching; a checked precision box overrides its precision
+    SeparationOptions options = SeparationTiers::options(tierCombo->currentData().toString());
+    if (int8Check->isChecked()) {
+        options.precision = ModelPrecision::Int8;
+    } else if (bf16Check->isChecked()) {
+        options.precision = ModelPrecision::BFloat16;
+    }
+    options.similarityGate = similarityGateCheck->isChecked();
+    rm->startSeparateAudio(filesToProcess, selectedFeatures, options);
 }
 
 void UseFeatureWidget::onProcessingProgress(int value)
@@ -309,7 +379,8 @@ void UseFeatureWidget::onSeparationProcessingFinished(const QStringList& results
 
 void UseFeatureWidget::onDeleteClicked()
 {
-    QString selectedFeature = featureComboBox->currentText();
+    QListWidgetItem* currentItem = featureList->currentItem();
+    QString selectedFeature = currentItem ? currentItem->text() : QString();
     if (selectedFeature.isEmpty()) {
         QMessageBox::warning(this, "Warning", "No feature selected to delete.");
         return;
@@ -4,6 +4,7 @@
 #include <QWidget>
 #include <QComboBox>
 #include <QPushButton>
+#include <QCheckBox>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -36,7 +37,11 @@ public:
 private:
     // UI Components
     QLabel* featureLabel;             ///< Label for feature selection
-    QComboBox* featureComboBox;       ///< Combo box to select sound feature
+    QListWidget* featureList;         ///< Sound features; several can be selected and separated in one pass
+    QComboBox* tierCombo;             ///< Speed/quality tier (SeparationTiers); item data is the tier name
+    QCheckBox* int8Check;             ///< Run the job with the INT8 model variants
+    QCheckBox* bf16Check;             ///< Run the job in bfloat16 (exclusive with int8Check)
+    QCheckBox* similarityGateCheck;   ///< HTSAT pre-pass: skip regions that do not resemble any selected feature
     QPushButton* processButton;       ///< Button to start processing
     QLabel* resultLabel;              ///< Label for results
     QListWidget* resultList;          ///< List widget for processed files with play buttons
@@ -50,6 +55,7 @@ private:
     void setupFeatureSelectionUI();           ///< Sets up the feature selection UI components
     void setupProcessingUI();                   ///< Sets up the processing UI components
     void setupConnections();                    ///< Sets up the signal-slot connections
+    void updateTierLabels();                    ///< Refreshes tier descriptions with measured realtime factors
 
 
 public slots:
@@ -0,0 +1,131 @@
+#include "workstealingpool.h"
+#include <QDebug>
+#include <algorithm>
+#include <exception>
+
+namespace {
+thread_local const WorkStealingPool* t_pool = nullptr; ///< Pool owning the current thread
+thread_local int t_index = -1;                         ///< Index of the current thread in t_pool
+}
+
+WorkStealingPool::WorkStealingPool(int numThreads, std::function<void(int)> threadInit)
+    : m_threadInit(std::move(threadInit))
+{
+    numThreads = std::max(1, numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < numThreads; ++i) {
+        m_threads.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_stopping = true;
+    }
+    m_workAvailable.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    int index = currentThreadIndex();
+    if (index < 0) {
+        index = static_cast<int>(m_nextQueue++ % m_queues.size());
+    }
+
+    ++m_unfinished;
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        ++m_queued;
+    }
+    m_workAvailable.notify_one();
+}
+
+void WorkStealingPool::waitForIdle()
+{
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    m_idle.wait(lock, [this] { return m_unfinished == 0; });
+}
+
+int WorkStealingPool::threadCount() const
+{
+    return static_cast<int>(m_threads.size());
+}
+
+int WorkStealingPool::currentThreadIndex() const
+{
+    return t_pool == this ? t_index : -1;
+}
+
+void WorkStealingPool::run(int index)
+{
+    t_pool = this;
+    t_index = index;
+    if (m_threadInit) {
+        m_threadInit(index);
+    }
+
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                qDebug() << "WorkStealingPool: task threw:" << e.what();
+            } catch (...) {
+                qDebug() << "WorkStealingPool: task threw an unknown exception";
+            }
+
+            if (--m_unfinished == 0) {
+                std::lock_guard<std::mutex> lock(m_stateMutex);
+                m_idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_stateMutex);
+        m_workAvailable.wait(lock, [this] { return m_stopping || m_queued > 0; });
+        if (m_stopping) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(int index, Task& task)
+{
+    Queue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    --m_queued;
+    return true;
+}
+
+bool WorkStealingPool::steal(int thief, Task& task)
+{
+    const int count = static_cast<int>(m_queues.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Queue& queue = *m_queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+    return false;
+}
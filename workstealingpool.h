@@ -0,0 +1,80 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size thread pool with per-thread deques and work stealing.
+ *
+ * Tasks submitted from a pool thread go to that thread's own deque and are
+ * popped LIFO, which keeps a file's chunks on the thread that decoded it.
+ * Idle threads steal FIFO from the other deques, so short and long files
+ * interleave and no thread idles while work remains anywhere in the pool.
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Starts the pool.
+     * @param numThreads Number of worker threads (at least 1).
+     * @param threadInit Optional callback run once on each thread before it takes work.
+     */
+    explicit WorkStealingPool(int numThreads, std::function<void(int)> threadInit = nullptr);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Queues a task. Called from a pool thread, the task goes to its own deque.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Blocks until every submitted task, including tasks they submit, has finished.
+     */
+    void waitForIdle();
+
+    /**
+     * @brief Number of worker threads.
+     */
+    int threadCount() const;
+
+    /**
+     * @brief Index of the calling pool thread, or -1 when called from outside this pool.
+     */
+    int currentThreadIndex() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(int index);
+    bool popLocal(int index, Task& task);
+    bool steal(int thief, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::function<void(int)> m_threadInit;
+
+    std::mutex m_stateMutex;                 ///< Guards sleeping and idle waits
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_idle;
+    std::atomic<int64_t> m_queued{0};        ///< Tasks sitting in deques
+    std::atomic<int64_t> m_unfinished{0};    ///< Tasks submitted but not yet finished
+    std::atomic<unsigned> m_nextQueue{0};    ///< Round-robin target for external submissions
+    bool m_stopping = false;
+};
+
+#endif // WORKSTEALINGPOOL_H
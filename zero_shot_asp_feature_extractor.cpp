@@ -1,32 +1,26 @@
 // ZeroShotASPFeatureExtractor.cpp
 #include "zero_shot_asp_feature_extractor.h"
-#include <QFileInfo>
+#include "modelregistry.h"
 #include <torch/script.h>
-#include <QResource>
-#include <QTemporaryFile>
+#include <QDebug>
 
 ZeroShotASPFeatureExtractor::ZeroShotASPFeatureExtractor(QObject* parent)
     : QObject(parent), modelLoaded(false)
 {
 }
 
-bool ZeroShotASPFeatureExtractor::loadModel(const QString& modelPath)
+bool ZeroShotASPFeatureExtractor::loadModel(const QString& modelPath, torch::ScalarType dtype)
 {
-    QFileInfo fi(modelPath);
-    if (!fi.exists()) {
-        emit error("Model file does not exist: " + modelPath);
-        return false;
-    }
-
-    try {
-        model = torch::jit::load(modelPath.toStdString());
-        modelLoaded = true;
-        return true;
-    } catch (const c10::Error& e) {
-        emit error("Failed to load model: " + QString::fromStdString(e.what()));
+    QString errorMessage;
+    backend = InferenceBackends::openSeparation(modelPath, dtype, &errorMessage);
+    if (!backend) {
+        emit error("Failed to load model: " + errorMessage);
         modelLoaded = false;
         return false;
     }
+    modelKey = ModelRegistry::keyFor(modelPath, dtype);
+    modelLoaded = true;
+    return true;
 }
 
 torch::Tensor ZeroShotASPFeatureExtractor::forward(const torch::Tensor& waveform,
@@ -38,78 +32,97 @@ torch::Tensor ZeroShotASPFeatureExtractor::forward(const torch::Tensor& waveform
     }
 
     // Check input shapes
-    if (waveform.dim() != 3 || waveform.size(0) != 1 || waveform.size(2) != 1) {
+    if (waveform.dim() != 3 || waveform.size(0) < 1 || waveform.size(2) != 1) {
         emit error("Invalid waveform tensor shape");
         return torch::Tensor();
     }
 
-    if (condition.dim() != 2 || condition.size(0) != 1 || condition.size(1) != 2048) {
+    const int64_t batchSize = waveform.size(0);
+    if (condition.dim() != 2 || condition.size(1) != 2048
+        || (condition.size(0) != 1 && condition.size(0) != batchSize)) {
         emit error("Invalid condition tensor shape");
         return torch::Tensor();
     }
 
     try {
-        std::vector<torch::jit::IValue> inputs = {waveform, condition};
-        torch::Tensor output = model.forward(inputs).toTensor();
+        // A single query vector is shared by every chunk in the batch
+        torch::Tensor batchedCondition = condition.size(0) == batchSize
+            ? condition
+            : condition.expand({batchSize, condition.size(1)});
+        torch::Tensor output = backend->separate(waveform, batchedCondition);
         emit finished(output);
         return output;
     } catch (const c10::Error& e) {
         emit error("Forward pass error: " + QString::fromStdString(e.what()));
         return torch::Tensor();
+    } catch (const std::exception& e) {
+        emit error("Forward pass error: " + QString::fromStdString(e.what()));
+        return torch::Tensor();
     }
 }
 
-void ZeroShotASPFeatureExtractor::unloadModel()
-{
-    model = torch::jit::script::Module();
-    modelLoaded = false;
-}
-
-bool ZeroShotASPFeatureExtractor::loadModelFromResource(const QString& resourcePath)
+torch::Tensor ZeroShotASPFeatureExtractor::separate(const torch::Tensor& waveform,
+                                                     const torch::Tensor& conditions)
 {
-    QResource resource(resourcePath);
-    if (!resource.isValid()) {
-        emit error("Invalid resource path: " + resourcePath);
-        return false;
+    if (!modelLoaded) {
+        emit error("Model not loaded");
+        return torch::Tensor();
     }
-
-    QTemporaryFile tempFile;
-    tempFile.setAutoRemove(false);
-    
-    if (!tempFile.open()) {
-        emit error("Failed to create temporary file for model");
-        return false;
+    if (waveform.dim() != 3 || waveform.size(0) < 1 || waveform.size(2) != 1) {
+        emit error("Invalid waveform tensor shape");
+        return torch::Tensor();
     }
-
-    QByteArray data = resource.uncompressedData();
-    if (data.isEmpty()) {
-        emit error("Resource data is empty");
-        return false;
+    if (conditions.dim() != 2 || conditions.size(0) < 1 || conditions.size(1) != 2048) {
+        emit error("Invalid condition tensor shape");
+        return torch::Tensor();
     }
 
-    qint64 bytesWritten = tempFile.write(data);
-    if (bytesWritten != data.size()) {
-        emit error("Failed to write complete model data to temporary file");
-        tempFile.close();
-        return false;
+    try {
+        torch::Tensor output = backend->separateMany(waveform, conditions);
+        emit finished(output);
+        return output;
+    } catch (const c10::Error& e) {
+        emit error("Encode/decode error: " + QString::fromStdString(e.what()));
+        return torch::Tensor();
+    } catch (const std::exception& e) {
+        emit error("Encode/decode error: " + QString::fromStdString(e.what()));
+        return torch::Tensor();
     }
+}
 
-    tempFile.close();
+bool ZeroShotASPFeatureExtractor::hasSplitInference() const
+{
+    return modelLoaded && backend->sharesMixtureEncoding();
+}
 
-    try {
-        model = torch::jit::load(tempFile.fileName().toStdString());
-        modelLoaded = true;
-        
-        QFile::remove(tempFile.fileName());
-        
-        qDebug() << "Successfully loaded ZeroShotASP model from resource:" << resourcePath;
-        return true;
-    } catch (const c10::Error& e) {
-        emit error("Failed to load model: " + QString::fromStdString(e.what()));
+void ZeroShotASPFeatureExtractor::unloadModel()
+{
+    backend.reset();
+    modelLoaded = false;
+}
+
+QString ZeroShotASPFeatureExtractor::registryKey() const
+{
+    return modelLoaded ? modelKey : QString();
+}
+
+bool ZeroShotASPFeatureExtractor::isModelLoaded() const
+{
+    return modelLoaded;
+}
+
+bool ZeroShotASPFeatureExtractor::loadModelFromResource(const QString& resourcePath, torch::ScalarType dtype)
+{
+    QString errorMessage;
+    backend = InferenceBackends::openSeparation(resourcePath, dtype, &errorMessage);
+    if (!backend) {
+        emit error("Failed to load model: " + errorMessage);
         modelLoaded = false;
-        
-        QFile::remove(tempFile.fileName());
-        
         return false;
     }
+
+    modelKey = ModelRegistry::keyFor(resourcePath, dtype);
+    modelLoaded = true;
+    qDebug() << "Successfully loaded" << backend->name() << "ZeroShotASP model from resource:" << resourcePath;
+    return true;
 }
@@ -10,6 +10,7 @@
 #endif
 #include <QString>
 #include <QObject>
+#include "inferencebackend.h"
 
 class ZeroShotASPFeatureExtractor : public QObject
 {
@@ -19,27 +20,42 @@ public:
     ZeroShotASPFeatureExtractor(QObject* parent = nullptr);
     ~ZeroShotASPFeatureExtractor() = default;
 
-    // 載入 TorchScript 模型
-    bool loadModel(const QString& modelPath);
+    // 以目前的 inference backend 載入模型（dtype 為 kBFloat16 時以 bf16 權重推論；reference backend 不讀檔）
+    bool loadModel(const QString& modelPath, torch::ScalarType dtype = torch::kFloat);
 
-    // forward 計算
-    // waveform: (1, clip_samples, 1)
-    // condition: (1, 2048)
-    // return: separated waveform tensor (1, clip_samples, 1)
+    // forward 計算（支援批次）
+    // waveform: (N, clip_samples, 1)
+    // condition: (N, 2048) 或 (1, 2048)（會自動擴展到 N）
+    // return: separated waveform tensor (N, clip_samples, 1)，一律為 float32
     torch::Tensor forward(const torch::Tensor& waveform,
                           const torch::Tensor& condition);
 
-    // 卸載模型以釋放記憶體
+    // 分離 W 個 chunk 對 F 個 query
+    // backend 支援時（TorchScript 模型提供 encode / decode）每個 chunk 的 mixture encoding 只算一次，F 個 query 共用
+    // return: (W, F, clip_samples, 1)，一律為 float32
+    torch::Tensor separate(const torch::Tensor& waveform, const torch::Tensor& conditions);
+
+    // 模型是否共用 mixture encoding（TorchScript 模型提供 encode / decode）
+    bool hasSplitInference() const;
+
+    // 放開模型；ModelRegistry 沒有其他使用者時才會真正釋放
     void unloadModel();
 
+    // 已載入模型在 ModelRegistry 的 key（未載入時為空）
+    QString registryKey() const;
+
     // 從資源載入模型
-    bool loadModelFromResource(const QString& resourcePath);
+    bool loadModelFromResource(const QString& resourcePath, torch::ScalarType dtype = torch::kFloat);
+
+    // 模型是否已載入
+    bool isModelLoaded() const;
 
 signals:
     void finished(const torch::Tensor& output);
     void error(const QString& errorMessage);
 
 private:
-    torch::jit::script::Module model;
+    std::shared_ptr<SeparationBackend> backend; // TorchScript（模型由 ModelRegistry 共用）或 reference
     bool modelLoaded;
+    QString modelKey;
 };